@@ -0,0 +1,68 @@
+
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCConcurrentVector.h"
+#include "SJCVector.h"
+
+// CONCURRENT APPEND BENCHMARK
+// ============================
+// A fixed number of ints is appended by 1 to 64 threads, each pushing its share.
+// mutex      - one BasicSJCVector behind a std::mutex, the ingest path as it was.
+// lock-free  - BasicSJCConcurrentVector.
+// Millions of push_backs per second, wall clock, including thread start-up.
+
+namespace {
+
+constexpr std::size_t totalPushes = std::size_t{ 1 } << 23;
+
+template <typename Push>
+double millionsPerSecond(unsigned threads, Push push)
+{
+	const std::size_t share = totalPushes / threads;
+	std::vector<std::thread> producers;
+	producers.reserve(threads);
+	SJCBenchTimer timer;
+	for (unsigned t = 0; t < threads; t++) {
+		producers.emplace_back([&push, share, t] {
+			for (std::size_t i = 0; i < share; i++) push(static_cast<int>(t * share + i));
+		});
+	}
+	for (auto& producer : producers) producer.join();
+	return static_cast<double>(share * threads) / timer.ns() * 1e3;
+}
+
+double mutexRate(unsigned threads)
+{
+	BasicSJCVector<int> v;
+	std::mutex m;
+	const double rate = millionsPerSecond(threads, [&](int x) {
+		std::lock_guard<std::mutex> lock(m);
+		v.push_back(x);
+	});
+	sjcDoNotOptimize(v);
+	return rate;
+}
+
+double lockFreeRate(unsigned threads)
+{
+	BasicSJCConcurrentVector<int> v;
+	const double rate = millionsPerSecond(threads, [&](int x) { v.push_back(x); });
+	sjcDoNotOptimize(v);
+	return rate;
+}
+
+} // namespace
+
+void runConcurrentBench(std::ostream& os)
+{
+	os << "hardware threads: " << std::thread::hardware_concurrency() << "\n";
+	os << std::setw(8) << "threads" << std::setw(14) << "mutex M/s" << std::setw(16) << "lock-free M/s" << "\n";
+	for (unsigned threads = 1; threads <= 64; threads *= 2) {
+		os << std::setw(8) << threads << std::fixed << std::setprecision(1)
+			<< std::setw(14) << mutexRate(threads) << std::setw(16) << lockFreeRate(threads) << "\n";
+	}
+}
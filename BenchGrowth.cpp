@@ -0,0 +1,95 @@
+
+
+#include <iomanip>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCVector.h"
+
+// GROWTH POLICY BENCHMARK
+// ========================
+// Append-heavy workloads run once per growth policy:
+// small - many short vectors, all kept alive, as in our per-record buffers.
+// large - a few huge vectors.
+// The counting pass reports reallocations and bytes copied (via a trace policy) and peak live
+// memory (via SJCTrackingAllocator). A second, silent pass with std::allocator reports ns per push_back.
+
+namespace {
+
+struct GrowthBenchTrace {
+	static constexpr bool streaming = false;
+	inline static std::size_t reallocations = 0;
+	inline static std::size_t bytesCopied = 0;
+	template <typename Vec>
+	static void record(const Vec&, SJCEvent e, std::size_t bytes = 0) noexcept
+	{
+		if (e == SJCEvent::Resize) reallocations++;
+		else if (e == SJCEvent::CopyData) bytesCopied += bytes;
+	}
+};
+
+struct Workload {
+	const char* name;
+	std::size_t vectors;
+	std::size_t pushes;
+};
+
+template <typename Vec>
+std::size_t appendAll(const Workload& w)
+{
+	std::vector<Vec> live;
+	live.reserve(w.vectors);
+	std::size_t capacity = 0;
+	for (std::size_t v = 0; v < w.vectors; v++) {
+		Vec& vec = live.emplace_back();
+		for (std::size_t i = 0; i < w.pushes; i++) vec.push_back(static_cast<int>(i));
+		capacity += vec.capacity();
+	}
+	sjcDoNotOptimize(live);
+	return capacity;
+}
+
+template <typename Growth>
+void runPolicy(std::ostream& os, const char* policy, const Workload& w)
+{
+	using Counted = BasicSJCVector<int, SJCTrackingAllocator<int>, GrowthBenchTrace, Growth>;
+	using Timed = BasicSJCVector<int, std::allocator<int>, SilentTrace, Growth>;
+
+	GrowthBenchTrace::reallocations = GrowthBenchTrace::bytesCopied = 0;
+	SJCAllocCounters::reset();
+	const std::size_t capacity = appendAll<Counted>(w);
+	const std::size_t reallocations = GrowthBenchTrace::reallocations;
+	const std::size_t bytesCopied = GrowthBenchTrace::bytesCopied;
+	const std::size_t peak = SJCAllocCounters::peakBytes;
+
+	SJCBenchTimer timer;
+	appendAll<Timed>(w);
+	const double nsPerPush = timer.ns() / static_cast<double>(w.vectors * w.pushes);
+
+	os << std::left << std::setw(8) << w.name << std::setw(16) << policy << std::right
+		<< std::setw(14) << reallocations << std::setw(16) << bytesCopied << std::setw(16) << peak
+		<< std::setw(16) << capacity * sizeof(int) << std::setw(12) << std::fixed << std::setprecision(2)
+		<< nsPerPush << "\n";
+}
+
+template <typename ChunkGrowth>
+void runWorkload(std::ostream& os, const Workload& w, const char* chunkName)
+{
+	runPolicy<SJCDoublingGrowth>(os, "2x+1", w);
+	runPolicy<SJCGrowth1_5x>(os, "1.5x+1", w);
+	runPolicy<ChunkGrowth>(os, chunkName, w);
+	runPolicy<SJCPageGrowth<>>(os, "page(4K)", w);
+	runPolicy<SJCSizeClassGrowth<>>(os, "size-class", w);
+}
+
+} // namespace
+
+void runGrowthBench(std::ostream& os)
+{
+	os << std::left << std::setw(8) << "load" << std::setw(16) << "policy" << std::right
+		<< std::setw(14) << "reallocations" << std::setw(16) << "bytes copied" << std::setw(16) << "peak bytes"
+		<< std::setw(16) << "final bytes" << std::setw(12) << "ns/push" << "\n";
+	// Fixed chunks are quadratic on huge vectors, so each workload gets a chunk size that suits it
+	runWorkload<SJCChunkGrowth<16>>(os, { "small", 200000, 12 }, "chunk(16)");
+	runWorkload<SJCChunkGrowth<65536>>(os, { "large", 4, 4000000 }, "chunk(64K)");
+}
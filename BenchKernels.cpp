@@ -0,0 +1,68 @@
+
+
+#include <iomanip>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCKernels.h"
+
+// SIMD KERNEL BENCHMARK
+// ======================
+// GB/s (two inputs read plus one output written) for every kernel on every instruction set this CPU
+// supports, against the loop the old eager operator+ ran: copy the left operand, then add the right one
+// element by element with an int index.
+// Sizes cover L1, L2/L3 and main memory.
+
+namespace {
+
+void oldOperatorPlus(const int* a, const int* b, int* out, std::size_t n)
+{
+	std::copy(a, a + n, out);
+	for (int i = 0; i < static_cast<int>(n); i++) out[i] += b[i];
+}
+
+double gbPerSecond(SJCBinaryKernel kernel, const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out)
+{
+	const std::size_t n = a.size();
+	const std::size_t reps = std::max<std::size_t>(1, (std::size_t{ 1 } << 27) / n);
+	kernel(a.data(), b.data(), out.data(), n);	// warm up
+	SJCBenchTimer timer;
+	for (std::size_t r = 0; r < reps; r++) {
+		kernel(a.data(), b.data(), out.data(), n);
+		sjcDoNotOptimize(out);
+	}
+	const double bytes = 3.0 * sizeof(int) * static_cast<double>(n) * static_cast<double>(reps);
+	return bytes / timer.ns();
+}
+
+} // namespace
+
+void runKernelBench(std::ostream& os)
+{
+	struct Named { const char* name; SJCBinaryKernel SJCKernelTable::* kernel; };
+	const Named kernels[] = {
+		{ "add", &SJCKernelTable::add }, { "sub", &SJCKernelTable::sub }, { "mul", &SJCKernelTable::mul },
+		{ "min", &SJCKernelTable::min }, { "max", &SJCKernelTable::max },
+		{ "equal", &SJCKernelTable::equal }, { "greater", &SJCKernelTable::greater },
+	};
+	os << "dispatch picks: " << sjcKernels().isa << "\n";
+	os << std::left << std::setw(10) << "elements" << std::setw(10) << "kernel" << std::setw(10) << "isa"
+		<< std::right << std::setw(10) << "GB/s" << "\n";
+	for (std::size_t n : { std::size_t{ 4096 }, std::size_t{ 1 } << 18, std::size_t{ 1 } << 24 }) {
+		std::vector<int> a(n), b(n), out(n);
+		for (std::size_t i = 0; i < n; i++) {
+			a[i] = static_cast<int>(i * 7 % 1000);
+			b[i] = static_cast<int>(i * 13 % 1000);
+		}
+		auto row = [&] (const char* kernel, const char* isa, double gbs) {
+			os << std::left << std::setw(10) << n << std::setw(10) << kernel << std::setw(10) << isa
+				<< std::right << std::setw(10) << std::fixed << std::setprecision(2) << gbs << "\n";
+		};
+		row("add", "old loop", gbPerSecond(oldOperatorPlus, a, b, out));
+		for (const Named& k : kernels) {
+			for (SJCIsa isa : { SJCIsa::Scalar, SJCIsa::SSE2, SJCIsa::AVX2, SJCIsa::AVX512 }) {
+				if (const SJCKernelTable* table = sjcKernelsFor(isa)) row(k.name, table->isa, gbPerSecond(table->*k.kernel, a, b, out));
+			}
+		}
+	}
+}
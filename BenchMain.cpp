@@ -0,0 +1,40 @@
+
+
+#include <cstring>
+#include <iostream>
+
+#include "SJCBench.h"
+
+// Runs every suite, or only the suites named on the command line e.g. SJCVectorBench growth
+// A single named suite prints no banner, so e.g. SJCVectorBench special > special.json is plain JSON
+struct SJCBenchSuite {
+	const char* name;
+	void (*run)(std::ostream&);
+};
+
+static const SJCBenchSuite suites[] = {
+	{ "growth", runGrowthBench },
+	{ "kernels", runKernelBench },
+	{ "concurrent", runConcurrentBench },
+	{ "pmr", runPmrBench },
+	{ "pool", runPoolBench },
+	{ "mapped", runMappedBench },
+	{ "special", runSpecialBench },
+	{ "push", runPushBench },
+	{ "propagation", runPropagationBench },
+};
+
+int main(int argc, char* argv[]) {
+	for (const auto& suite : suites) {
+		bool wanted = (argc < 2);
+		for (int i = 1; i < argc; i++) wanted = wanted || (std::strcmp(argv[i], suite.name) == 0);
+		if (!wanted) continue;
+		if (argc == 2) {
+			suite.run(std::cout);
+			continue;
+		}
+		std::cout << "=== " << suite.name << " ===\n";
+		suite.run(std::cout);
+		std::cout << "\n";
+	}
+}
@@ -0,0 +1,105 @@
+
+#include <cstdio>
+#include <iomanip>
+
+#include "SJCBench.h"
+
+#if defined(_WIN32)
+
+void runMappedBench(std::ostream& os)
+{
+	os << "needs POSIX mmap, skipped\n";
+}
+
+#else
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "SJCMappedVector.h"
+#include "SJCVector.h"
+
+// FILE-BACKED LOAD BENCHMARK
+// ===========================
+// A file of ints is loaded and summed.
+// read    - one read() into a BasicSJCVector of the file's size, the way datasets were loaded.
+// mapped  - BasicSJCMappedVector in ReadOnly mode.
+// Milliseconds to open (the vector is usable) and to open and touch every item. The file is in the page
+// cache after it is written, so this measures the copy the mapping avoids, not the disk.
+// flush   - msync of a Shared mapping with a 64-byte header before the items (SJCSerialize.h's layout),
+//           which must sync from the page-aligned start of the mapping rather than from the first item.
+
+namespace {
+
+constexpr const char* path = "sjc_mapped_bench.bin";
+constexpr const char* headerPath = "sjc_mapped_bench_header.bin";
+
+long long sum(const int* p, std::size_t n)
+{
+	long long s = 0;
+	for (std::size_t i = 0; i < n; i++) s += p[i];
+	return s;
+}
+
+void readLoad(std::size_t count, double& openMs, double& totalMs)
+{
+	SJCBenchTimer timer;
+	BasicSJCVector<int> v(count);
+	const int fd = ::open(path, O_RDONLY);
+	std::size_t done = 0;
+	char* dst = reinterpret_cast<char*>(v.data());
+	while (fd >= 0 && done < count * sizeof(int)) {
+		const ssize_t n = ::read(fd, dst + done, count * sizeof(int) - done);
+		if (n <= 0) break;
+		done += static_cast<std::size_t>(n);
+	}
+	if (fd >= 0) ::close(fd);
+	openMs = timer.ns() / 1e6;
+	sjcDoNotOptimize(sum(v.data(), done / sizeof(int)));
+	totalMs = timer.ns() / 1e6;
+}
+
+void mappedLoad(double& openMs, double& totalMs)
+{
+	SJCBenchTimer timer;
+	BasicSJCMappedVector<int> v(path);
+	openMs = timer.ns() / 1e6;
+	sjcDoNotOptimize(sum(v.data(), v.size()));
+	totalMs = timer.ns() / 1e6;
+}
+
+double flushMs(std::size_t count)
+{
+	std::remove(headerPath);
+	BasicSJCMappedVector<int> out(headerPath, SJCMapMode::Shared, 64);
+	for (std::size_t i = 0; i < count; i++) out.push_back(static_cast<int>(i));
+	SJCBenchTimer timer;
+	out.flush();
+	return timer.ns() / 1e6;
+}
+
+} // namespace
+
+void runMappedBench(std::ostream& os)
+{
+	os << std::setw(10) << "MB" << std::setw(14) << "read open" << std::setw(14) << "read+sum" << std::setw(14) << "map open"
+		<< std::setw(14) << "map+sum" << std::setw(14) << "flush" << "\n";
+	for (std::size_t count : { std::size_t{ 1 } << 20, std::size_t{ 1 } << 24, std::size_t{ 1 } << 26 }) {
+		{
+			std::remove(path);
+			BasicSJCMappedVector<int> out(path, SJCMapMode::Shared);
+			for (std::size_t i = 0; i < count; i++) out.push_back(static_cast<int>(i));
+		}
+		double readOpen, readTotal, mapOpen, mapTotal;
+		readLoad(count, readOpen, readTotal);
+		mappedLoad(mapOpen, mapTotal);
+		const double flush = flushMs(count);
+		os << std::setw(10) << count * sizeof(int) / (1 << 20) << std::fixed << std::setprecision(2)
+			<< std::setw(14) << readOpen << std::setw(14) << readTotal << std::setw(14) << mapOpen << std::setw(14) << mapTotal
+			<< std::setw(14) << flush << "\n";
+	}
+	std::remove(path);
+	std::remove(headerPath);
+}
+
+#endif
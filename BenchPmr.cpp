@@ -0,0 +1,87 @@
+
+#include <iomanip>
+#include <memory_resource>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCPmrVector.h"
+
+// MEMORY RESOURCE BENCHMARK
+// ==========================
+// A request builds a batch of short-lived vectors and drops them all when it ends.
+// heap      - BasicSJCVector with std::allocator: every buffer and every growth goes to the global heap.
+// arena     - SJCPmrVectorOf over a std::pmr::monotonic_buffer_resource that starts in a reused buffer and is
+//             released once per request, so freeing a buffer costs nothing.
+// pool      - SJCPmrVectorOf over a std::pmr::unsynchronized_pool_resource shared by all requests.
+// ns per request.
+
+namespace {
+
+struct Request {
+	const char* name;
+	std::size_t vectors;
+	std::size_t pushes;
+};
+
+constexpr std::size_t requests = 20000;
+
+template <typename Vec, typename... Args>
+void serve(std::vector<Vec>& live, const Request& r, Args&&... args)
+{
+	for (std::size_t v = 0; v < r.vectors; v++) {
+		Vec& vec = live.emplace_back(args...);
+		for (std::size_t i = 0; i < r.pushes; i++) vec.push_back(static_cast<int>(i));
+	}
+	sjcDoNotOptimize(live);
+	live.clear();
+}
+
+double heapNs(const Request& r)
+{
+	using Vec = BasicSJCVector<int>;
+	std::vector<Vec> live;
+	live.reserve(r.vectors);
+	SJCBenchTimer timer;
+	for (std::size_t q = 0; q < requests; q++) serve(live, r);
+	return timer.ns() / requests;
+}
+
+double arenaNs(const Request& r)
+{
+	using Vec = BasicSJCVector<int, std::pmr::polymorphic_allocator<int>>;
+	std::vector<Vec> live;
+	live.reserve(r.vectors);
+	std::vector<std::byte> initial(std::size_t{ 1 } << 20);
+	std::pmr::monotonic_buffer_resource arena(initial.data(), initial.size());
+	SJCBenchTimer timer;
+	for (std::size_t q = 0; q < requests; q++) {
+		serve(live, r, &arena);
+		arena.release();	// Drops the whole request at once
+	}
+	return timer.ns() / requests;
+}
+
+double poolNs(const Request& r)
+{
+	using Vec = BasicSJCVector<int, std::pmr::polymorphic_allocator<int>>;
+	std::vector<Vec> live;
+	live.reserve(r.vectors);
+	std::pmr::unsynchronized_pool_resource pool;
+	SJCBenchTimer timer;
+	for (std::size_t q = 0; q < requests; q++) serve(live, r, &pool);
+	return timer.ns() / requests;
+}
+
+} // namespace
+
+void runPmrBench(std::ostream& os)
+{
+	os << std::left << std::setw(10) << "request" << std::right << std::setw(10) << "vectors" << std::setw(10) << "pushes"
+		<< std::setw(12) << "heap ns" << std::setw(12) << "arena ns" << std::setw(12) << "pool ns" << "\n";
+	const Request loads[] = { { "tiny", 64, 4 }, { "small", 32, 24 }, { "medium", 8, 1000 } };
+	for (const auto& r : loads) {
+		os << std::left << std::setw(10) << r.name << std::right << std::setw(10) << r.vectors << std::setw(10) << r.pushes
+			<< std::fixed << std::setprecision(0) << std::setw(12) << heapNs(r) << std::setw(12) << arenaNs(r)
+			<< std::setw(12) << poolNs(r) << "\n";
+	}
+}
@@ -0,0 +1,51 @@
+
+#include <algorithm>
+#include <iomanip>
+
+#include "SJCBench.h"
+#include "SJCPoolAllocator.h"
+#include "SJCVector.h"
+
+// BUFFER POOL BENCHMARK
+// ======================
+// The arithmetic pattern the pool is for: SJCVector o(n + m) in a loop, so every iteration allocates the
+// result and frees it again. ns per expression with std::allocator and with SJCPoolAllocator, and the
+// pool's hit rate for the run.
+
+namespace {
+
+template <typename Vec>
+double nsPerSum(std::size_t size, std::size_t reps)
+{
+	Vec n, m;
+	for (std::size_t i = 0; i < size; i++) {
+		n.push_back(static_cast<int>(i));
+		m.push_back(static_cast<int>(2 * i));
+	}
+	SJCBenchTimer timer;
+	for (std::size_t r = 0; r < reps; r++) {
+		Vec o(n + m);
+		sjcDoNotOptimize(o);
+	}
+	return timer.ns() / static_cast<double>(reps);
+}
+
+} // namespace
+
+void runPoolBench(std::ostream& os)
+{
+	using Pool = SJCBufferPool<(std::size_t{ 4 } << 20)>;
+	os << std::setw(10) << "size" << std::setw(14) << "heap ns" << std::setw(14) << "pool ns" << std::setw(12) << "hit rate" << "\n";
+	for (std::size_t size : { 16, 1000, 100000 }) {
+		const std::size_t reps = std::max<std::size_t>(1000, (std::size_t{ 1 } << 24) / size);
+		const double heap = nsPerSum<BasicSJCVector<int>>(size, reps);
+		const SJCPoolStats before = Pool::stats();
+		const double pooled = nsPerSum<BasicSJCVector<int, SJCPoolAllocator<int>>>(size, reps);
+		const SJCPoolStats after = Pool::stats();
+		SJCPoolStats run;
+		run.hits = after.hits - before.hits;
+		run.misses = after.misses - before.misses;
+		os << std::setw(10) << size << std::fixed << std::setprecision(1) << std::setw(14) << heap << std::setw(14) << pooled
+			<< std::setprecision(3) << std::setw(12) << run.hitRate() << "\n";
+	}
+}
@@ -0,0 +1,144 @@
+#include <cstddef>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "SJCBench.h"
+#include "SJCVector.h"
+
+// ALLOCATOR PROPAGATION CHECK
+// ============================
+// Not a timing: checks BasicSJCVector's assignments and swap against the standard container rules (see
+// ALLOCATOR PROPAGATION in SJCVector.h) for all eight combinations of the propagate_on_container_copy_assignment,
+// _move_assignment and _swap traits. SJCTaggedAllocator instances are equal only when their ids are, and every
+// buffer must be freed by an allocator with the id that allocated it.
+// Each case assigns from (or swaps with) a vector on allocator 2 into one on allocator 1, and prints the id
+// *this ends up with. move and by-value also show whether the buffer was stolen or its items moved.
+// A line ends in FAIL if any result breaks the rules. The by-value operator is checked with SJCByValueAssign.
+
+namespace {
+
+struct SJCAllocationLog {
+	std::map<const void*, int> owners;	// Live buffer -> id of the allocator that made it
+	int wrongFrees = 0;
+};
+SJCAllocationLog allocationLog;
+
+template <typename T, bool Copy, bool Move, bool Swap>
+struct SJCTaggedAllocator {
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::bool_constant<Copy>;
+	using propagate_on_container_move_assignment = std::bool_constant<Move>;
+	using propagate_on_container_swap = std::bool_constant<Swap>;
+	using is_always_equal = std::false_type;
+	template <typename U>
+	struct rebind { using other = SJCTaggedAllocator<U, Copy, Move, Swap>; };
+
+	int id = 0;
+
+	SJCTaggedAllocator() = default;
+	explicit SJCTaggedAllocator(int i) noexcept : id(i) {}
+	template <typename U>
+	SJCTaggedAllocator(const SJCTaggedAllocator<U, Copy, Move, Swap>& other) noexcept : id(other.id) {}
+
+	T* allocate(std::size_t n)
+	{
+		T* p = std::allocator<T>().allocate(n);
+		allocationLog.owners[p] = id;
+		return p;
+	}
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		auto it = allocationLog.owners.find(p);
+		if (it == allocationLog.owners.end() || it->second != id) allocationLog.wrongFrees++;
+		if (it != allocationLog.owners.end()) allocationLog.owners.erase(it);
+		std::allocator<T>().deallocate(p, n);
+	}
+	friend bool operator==(const SJCTaggedAllocator& a, const SJCTaggedAllocator& b) noexcept { return a.id == b.id; }
+	friend bool operator!=(const SJCTaggedAllocator& a, const SJCTaggedAllocator& b) noexcept { return a.id != b.id; }
+};
+
+template <typename Vec>
+Vec filled(int id, int first)
+{
+	using A = typename Vec::allocator_type;
+	Vec v("v", 1, A(id));
+	for (int i = 0; i < 100; i++) v.push_back(first + i);
+	return v;
+}
+
+template <typename Vec>
+bool holds(const Vec& v, int first)
+{
+	if (v.size() != 100) return false;
+	for (std::size_t i = 0; i < v.size(); i++) {
+		if (v[i] != first + static_cast<int>(i)) return false;
+	}
+	return true;
+}
+
+// Runs one assignment from a vector on allocator 2 into one on allocator 1. Returns the id *this ends up with
+// and whether rhs's buffer was stolen, or -1 if the items or the allocator are wrong.
+template <typename Vec, typename Assign>
+std::pair<int, bool> assigned(int expectedId, Assign assign)
+{
+	Vec lhs = filled<Vec>(1, 0);
+	Vec rhs = filled<Vec>(2, 1000);
+	const int* stealable = rhs.data();
+	assign(lhs, rhs);
+	const int id = lhs.get_allocator().id;
+	if (!holds(lhs, 1000) || id != expectedId) return { -1, false };
+	return { id, lhs.data() == stealable };
+}
+
+template <bool Copy, bool Move, bool Swap>
+void checkTraits(std::ostream& os)
+{
+	using Alloc = SJCTaggedAllocator<int, Copy, Move, Swap>;
+	using Split = BasicSJCVector<int, Alloc, SilentTrace, SJCDoublingGrowth, 0, SJCSplitAssign>;
+	using ByValue = BasicSJCVector<int, Alloc, SilentTrace, SJCDoublingGrowth, 0, SJCByValueAssign>;
+	const int wrongBefore = allocationLog.wrongFrees;
+	bool ok = true;
+
+	const auto copy = assigned<Split>(Copy ? 2 : 1, [](Split& l, Split& r) { l = r; });
+	const auto move = assigned<Split>(Move ? 2 : 1, [](Split& l, Split& r) { l = std::move(r); });
+	const auto byValue = assigned<ByValue>(Move ? 2 : 1, [](ByValue& l, ByValue& r) { l = std::move(r); });
+	ok = ok && copy.first > 0 && move.first > 0 && byValue.first > 0;
+	// A buffer is stolen exactly when the allocator propagates, the allocators being unequal
+	ok = ok && !copy.second && move.second == Move && byValue.second == Move;
+	ok = ok && noexcept(std::declval<Split&>() = std::declval<Split&&>()) == Move;
+
+	// Equal allocators always swap, unequal ones only when they propagate
+	int swapped = 1;
+	{
+		Split a = filled<Split>(Swap ? 1 : 2, 0);
+		Split b = filled<Split>(2, 1000);
+		a.swap(b);
+		swapped = a.get_allocator().id;
+		ok = ok && holds(a, 1000) && holds(b, 0) && swapped == 2 && b.get_allocator().id == (Swap ? 1 : 2);
+	}
+	const int wrongFrees = allocationLog.wrongFrees - wrongBefore;
+	ok = ok && wrongFrees == 0;
+
+	auto steal = [](std::pair<int, bool> r) { return r.second ? " stolen" : " moved "; };
+	os << std::setw(6) << Copy << std::setw(6) << Move << std::setw(6) << Swap
+		<< std::setw(8) << copy.first << std::setw(6) << move.first << steal(move)
+		<< std::setw(6) << byValue.first << steal(byValue) << std::setw(6) << swapped
+		<< std::setw(8) << wrongFrees << (ok ? "   ok" : "   FAIL") << "\n";
+}
+
+} // namespace
+
+void runPropagationBench(std::ostream& os)
+{
+	os << " POCCA POCMA  POCS   copy=  move=        by-value=    swap  bad frees\n";
+	checkTraits<false, false, false>(os);
+	checkTraits<false, false, true>(os);
+	checkTraits<false, true, false>(os);
+	checkTraits<false, true, true>(os);
+	checkTraits<true, false, false>(os);
+	checkTraits<true, false, true>(os);
+	checkTraits<true, true, false>(os);
+	checkTraits<true, true, true>(os);
+}
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCVector.h"
+
+// PUSH_BACK BENCHMARK
+// ====================
+// Millions of appends per second, filling a fresh vector of ints to size by push_back, for std::vector and
+// BasicSJCVector, and for BasicSJCVector's emplace_back. The "reserved" columns reserve size first, so they
+// time the inlined fast path alone; the others include the growth path's reallocations and copies.
+
+namespace {
+
+template <typename Vec, typename Append>
+double appendsPerSec(std::size_t size, std::size_t reps, bool reserve, Append append)
+{
+	SJCBenchTimer timer;
+	for (std::size_t r = 0; r < reps; r++) {
+		Vec v;
+		if (reserve) v.reserve(size);
+		for (std::size_t i = 0; i < size; i++) append(v, static_cast<int>(i));
+		sjcDoNotOptimize(v.data()[size - 1]);
+	}
+	return static_cast<double>(size * reps) / timer.ns() * 1e3;
+}
+
+} // namespace
+
+void runPushBench(std::ostream& os)
+{
+	const auto push = [](auto& v, int i) { v.push_back(i); };
+	const auto emplace = [](auto& v, int i) { v.emplace_back(i); };
+	os << "M appends/s\n";
+	os << std::setw(10) << "size" << std::setw(14) << "std::vector" << std::setw(14) << "push_back" << std::setw(14) << "emplace_back"
+		<< std::setw(14) << "std reserved" << std::setw(14) << "SJC reserved" << "\n";
+	for (std::size_t size : { 1000, 100000, 10000000 }) {
+		const std::size_t reps = std::max<std::size_t>(1, (std::size_t{ 1 } << 26) / size);
+		os << std::setw(10) << size << std::fixed << std::setprecision(0)
+			<< std::setw(14) << appendsPerSec<std::vector<int>>(size, reps, false, push)
+			<< std::setw(14) << appendsPerSec<BasicSJCVector<int>>(size, reps, false, push)
+			<< std::setw(14) << appendsPerSec<BasicSJCVector<int>>(size, reps, false, emplace)
+			<< std::setw(14) << appendsPerSec<std::vector<int>>(size, reps, true, push)
+			<< std::setw(14) << appendsPerSec<BasicSJCVector<int>>(size, reps, true, push) << "\n";
+	}
+}
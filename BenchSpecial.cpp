@@ -0,0 +1,133 @@
+
+#include <iomanip>
+#include <vector>
+
+#include "SJCBench.h"
+#include "SJCVector.h"
+#include "SJCVectorStats.h"
+
+// SPECIAL MEMBER FUNCTION BENCHMARK
+// ===================================
+// Times each special member function of BasicSJCVector<int> on vectors of 0 to 1e8 items and writes the
+// results as JSON, one object per operation and size:
+//		ns_per_op            - wall clock, SilentTrace, averaged over reps operations
+//		allocations_per_op   - from one operation on the same vector with CountingTrace
+//		bytes_copied_per_op  - likewise, element data copied (see SJCEvent::CopyData)
+// Operands are set up before the clock starts and cleaned up after it stops, so only the operation is timed.
+// Memory: the source vector plus the copies an operation works on. That is at most about 64 MB of copies for
+// small vectors, but a single big vector takes the source and up to two copies (the assigned-to vector and
+// the assignment's temporary, or the two sides of a move or swap): about 1.2 GB at 1e8 items.
+// copy_assign and move_assign are measured for every assignment policy (see SJCAssignPolicy.h), named by
+// "assignment": by-value and split are the two sides of BY_VAL_OPERATOR, reuse is SJCReuseAssign.
+
+namespace {
+
+enum class Op { DefaultCtor, SizedCtor, CopyCtor, MoveCtor, CopyAssign, MoveAssign, Swap, Dtor, Count };
+const char* const opNames[] = { "default_ctor", "sized_ctor", "copy_ctor", "move_ctor", "copy_assign", "move_assign",
+	"swap", "dtor" };
+
+template <typename Trace, typename Assign>
+using BenchVec = BasicSJCVector<int, std::allocator<int>, Trace, SJCDoublingGrowth, 0, Assign>;
+
+// Enough operations to time small vectors. Below 16M items the copies they work on stay under about 64 MB.
+std::size_t repsFor(std::size_t size)
+{
+	const std::size_t budget = std::size_t{ 1 } << 24;
+	return std::max<std::size_t>(1, std::min<std::size_t>(100000, budget / std::max<std::size_t>(size, 1)));
+}
+
+struct TimeProbe {
+	SJCBenchTimer timer;
+	double ns = 0;
+	void start() { timer.restart(); }
+	void stop() { ns = timer.ns(); }
+};
+
+struct CountProbe {
+	SJCStatsSnapshot before;
+	SJCStats counted;
+	void start() { before = SJCStatsRegistry::snapshot(); }
+	void stop() { counted = (SJCStatsRegistry::snapshot() - before).total; }
+};
+
+// Runs op reps times on copies of src, with probe started and stopped around the operations only
+template <typename Vec, typename Probe>
+void runOp(Op op, const Vec& src, std::size_t reps, Probe& probe)
+{
+	std::vector<Vec> a, b;
+	a.reserve(reps);
+	b.reserve(reps);
+	const std::size_t setup = op == Op::Swap ? 1 : reps;
+	if (op == Op::MoveCtor || op == Op::CopyAssign || op == Op::MoveAssign || op == Op::Swap || op == Op::Dtor) {
+		for (std::size_t i = 0; i < setup; i++) a.emplace_back(src);
+	}
+	if (op == Op::MoveAssign || op == Op::Swap) {
+		for (std::size_t i = 0; i < setup; i++) b.emplace_back(src);
+	}
+	probe.start();
+	switch (op) {
+	case Op::DefaultCtor: for (std::size_t i = 0; i < reps; i++) b.emplace_back(); break;
+	case Op::SizedCtor: for (std::size_t i = 0; i < reps; i++) b.emplace_back(src.size()); break;
+	case Op::CopyCtor: for (std::size_t i = 0; i < reps; i++) b.emplace_back(src); break;
+	case Op::MoveCtor: for (std::size_t i = 0; i < reps; i++) b.emplace_back(std::move(a[i])); break;
+	case Op::CopyAssign: for (std::size_t i = 0; i < reps; i++) a[i] = src; break;
+	case Op::MoveAssign: for (std::size_t i = 0; i < reps; i++) a[i] = std::move(b[i]); break;
+	case Op::Swap: for (std::size_t i = 0; i < reps; i++) swap(a[0], b[0]); break;
+	case Op::Dtor: a.clear(); break;
+	case Op::Count: break;
+	}
+	probe.stop();
+	sjcDoNotOptimize(a);
+	sjcDoNotOptimize(b);
+}
+
+template <typename Vec>
+void fill(Vec& v, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; i++) v.push_back(static_cast<int>(i));
+}
+
+// Writes a result for each op in [first, last), on vectors of size items with assignment policy Assign
+template <typename Assign>
+void measure(std::ostream& os, const char*& separator, const char* assignment, std::size_t size, Op first, Op last)
+{
+	const std::size_t reps = repsFor(size);
+	BenchVec<SilentTrace, Assign> src;
+	src.reserve(size);
+	fill(src, size);
+	for (std::size_t o = static_cast<std::size_t>(first); o < static_cast<std::size_t>(last); o++) {
+		const Op op = static_cast<Op>(o);
+		TimeProbe time;
+		runOp(op, src, reps, time);
+		// The CountingTrace twin borrows src's buffer for the counted run (see adopt and release), so there is
+		// never a second copy of the source
+		BenchVec<CountingTrace, Assign> counted;
+		counted.adopt(src.release());
+		CountProbe count;
+		runOp(op, counted, 1, count);
+		src.adopt(counted.release());
+		os << separator << "    { \"op\": \"" << opNames[o] << "\", ";
+		if (assignment != nullptr) os << "\"assignment\": \"" << assignment << "\", ";
+		os << "\"size\": " << size << ", \"reps\": " << reps
+			<< std::fixed << std::setprecision(1) << ", \"ns_per_op\": " << time.ns / static_cast<double>(reps)
+			<< ", \"allocations_per_op\": " << count.counted.allocations()
+			<< ", \"bytes_copied_per_op\": " << count.counted.bytesCopied << " }";
+		separator = ",\n";
+	}
+}
+
+} // namespace
+
+void runSpecialBench(std::ostream& os)
+{
+	os << "{\n  \"suite\": \"special\",\n  \"results\": [";
+	const char* separator = "\n";
+	for (std::size_t size : { 0, 1, 16, 1000, 100000, 10000000, 100000000 }) {
+		measure<SJCDefaultAssign>(os, separator, nullptr, size, Op::DefaultCtor, Op::CopyAssign);
+		measure<SJCByValueAssign>(os, separator, "by-value", size, Op::CopyAssign, Op::Swap);
+		measure<SJCSplitAssign>(os, separator, "split", size, Op::CopyAssign, Op::Swap);
+		measure<SJCReuseAssign>(os, separator, "reuse", size, Op::CopyAssign, Op::Swap);
+		measure<SJCDefaultAssign>(os, separator, nullptr, size, Op::Swap, Op::Count);
+	}
+	os << "\n  ]\n}\n";
+}
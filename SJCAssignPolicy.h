@@ -0,0 +1,38 @@
+#pragma once
+
+// ASSIGNMENT POLICIES
+// ===================
+// BasicSJCVector's AssignPolicy picks its assignment operators at compile time, per vector type, where
+// BY_VAL_OPERATOR used to pick them once for the whole program.
+// SJCByValueAssign - rule of four and a half: a single operator=(BasicSJCVector) that takes its argument by
+//                    value and swaps with it. The caller's argument decides between copy and move.
+// SJCSplitAssign   - rule of five: operator=(const BasicSJCVector&) and operator=(BasicSJCVector&&), copy (or
+//                    move) and swap inside the operator. Costs the same as by-value.
+// SJCReuseAssign   - like SJCSplitAssign, but when the items fit in the existing buffer copy assignment copies
+//                    them there (memcpy for trivially copyable T) instead of building a full temporary, so
+//                    copy assignment in a loop stops allocating. The price: only the basic exception guarantee
+//                    when T's copy can throw, and the vector keeps its capacity when assigned a smaller one.
+// A policy provides:
+//		static constexpr bool byValue;			// the single by-value operator= rather than the split pair
+//		static constexpr bool reusesCapacity;	// copy assignment copies into the existing buffer when it fits
+// SJCDefaultAssign (in SJCVector.h) is SJCByValueAssign, or SJCSplitAssign when SJCVECTOR_SPLIT_ASSIGNMENT is defined.
+//		BasicSJCVector<int, std::allocator<int>, SilentTrace, SJCDoublingGrowth, 0, SJCReuseAssign> v;
+
+struct SJCByValueAssign {
+	static constexpr bool byValue = true;
+	static constexpr bool reusesCapacity = false;
+};
+
+struct SJCSplitAssign {
+	static constexpr bool byValue = false;
+	static constexpr bool reusesCapacity = false;
+};
+
+struct SJCReuseAssign {
+	static constexpr bool byValue = false;
+	static constexpr bool reusesCapacity = true;
+};
+
+// Parameter type of the assignment operators a policy does not use. Never defined, so nothing converts to it.
+template <int>
+struct SJCUnusedAssign;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+
+// BENCHMARK SUPPORT
+// ==================
+// Shared helpers for the SJCVectorBench target. Each suite lives in its own Bench*.cpp file
+// and is registered in BenchMain.cpp.
+
+// Suites
+void runGrowthBench(std::ostream& os);
+void runKernelBench(std::ostream& os);
+void runConcurrentBench(std::ostream& os);
+void runPmrBench(std::ostream& os);
+void runPoolBench(std::ostream& os);
+void runMappedBench(std::ostream& os);
+void runSpecialBench(std::ostream& os);
+void runPushBench(std::ostream& os);
+void runPropagationBench(std::ostream& os);
+
+// Keeps the optimizer from discarding a result that is otherwise unused
+inline const volatile void* volatile sjcBenchSink = nullptr;
+template <typename T>
+inline void sjcDoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	sjcBenchSink = &value;
+#endif
+}
+
+class SJCBenchTimer {
+	using clock = std::chrono::steady_clock;
+	clock::time_point start_ = clock::now();
+public:
+	void restart() noexcept { start_ = clock::now(); }
+	double ns() const noexcept { return std::chrono::duration<double, std::nano>(clock::now() - start_).count(); }
+};
+
+// TRACKING ALLOCATOR
+// ====================
+// Counts allocations, live bytes and the high-water mark of live bytes across all instances.
+// Single threaded: benchmarks using it must not allocate from several threads at once.
+struct SJCAllocCounters {
+	inline static std::size_t allocations = 0;
+	inline static std::size_t liveBytes = 0;
+	inline static std::size_t peakBytes = 0;
+	static void reset() noexcept { allocations = liveBytes = peakBytes = 0; }
+};
+
+template <typename T>
+struct SJCTrackingAllocator {
+	using value_type = T;
+	SJCTrackingAllocator() = default;
+	template <typename U>
+	SJCTrackingAllocator(const SJCTrackingAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+		T* p = std::allocator<T>().allocate(n);
+		SJCAllocCounters::allocations++;
+		SJCAllocCounters::liveBytes += n * sizeof(T);
+		SJCAllocCounters::peakBytes = std::max(SJCAllocCounters::peakBytes, SJCAllocCounters::liveBytes);
+		return p;
+	}
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		SJCAllocCounters::liveBytes -= n * sizeof(T);
+		std::allocator<T>().deallocate(p, n);
+	}
+	template <typename U>
+	bool operator==(const SJCTrackingAllocator<U>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const SJCTrackingAllocator<U>&) const noexcept { return false; }
+};
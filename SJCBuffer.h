@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// SJCBUFFER
+// =========
+// Allocator-aware helpers for the raw buffers owned by SJCVector.
+// Every slot of a buffer holds a live T, so a buffer of n slots is always created and destroyed as a whole.
+// Slots that are not filled from existing data are default-initialized by default, like
+// std::make_unique_for_overwrite<T[]>(n): for trivial T (int, double...) they are left unwritten, which saves
+// a full write pass over memory that push_back is about to overwrite anyway. Pass SJCFill::Zero when
+// value-initialized (zeroed) slots are actually required.
+// Types that are trivially copyable are copied with memcpy. Types that are trivially relocatable
+// (moving them to a new address and forgetting the old one is a memcpy) are grown with memcpy too.
+// Everything else falls back to element-wise std::move_if_noexcept.
+
+// Specialize for types that are safe to memcpy to a new address and abandon at the old one
+// e.g. template <> struct SJCTriviallyRelocatable<std::unique_ptr<int>> : std::true_type {};
+template <typename T>
+struct SJCTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Allocators may provide T* reallocate(T* p, std::size_t oldN, std::size_t count, std::size_t newN), which moves
+// the first count items of a buffer to a bigger one without going through the element type (see
+// SJCMmapAllocator.h), and static bool remaps(oldN, newN), which says whether that move copies the bytes or not.
+template <typename Allocator, typename = void>
+struct SJCHasReallocate : std::false_type {};
+template <typename Allocator>
+struct SJCHasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+	std::declval<typename std::allocator_traits<Allocator>::value_type*>(), std::size_t{}, std::size_t{}, std::size_t{}))>>
+	: std::true_type {};
+
+enum class SJCFill {
+	ForOverwrite,	// default-initialize: trivial types are left uninitialized
+	Zero			// value-initialize: trivial types are zeroed
+};
+
+template <typename Allocator>
+struct SJCBuffer {
+	using traits = std::allocator_traits<Allocator>;
+	using T = typename traits::value_type;
+	static constexpr bool triviallyCopyable = std::is_trivially_copyable_v<T>;
+	static constexpr bool triviallyRelocatable = SJCTriviallyRelocatable<T>::value;
+	// Trivial types need no construction or destruction, so their bytes can be moved by the allocator
+	static constexpr bool allocatorGrows = SJCHasReallocate<Allocator>::value && std::is_trivial_v<T>;
+
+	// Allocates n slots.
+	static T* make(Allocator& a, std::size_t n, SJCFill fill = SJCFill::ForOverwrite)
+	{
+		T* p = traits::allocate(a, n);
+		try {
+			construct(a, p, n, fill);
+		}
+		catch (...) {
+			traits::deallocate(a, p, n);
+			throw;
+		}
+		return p;
+	}
+	// Allocates n slots. The first count are copies of src[0, count), the rest are default-initialized.
+	static T* makeCopy(Allocator& a, const T* src, std::size_t count, std::size_t n)
+	{
+		T* p = traits::allocate(a, n);
+		try {
+			copyInto(a, src, count, p, n);
+		}
+		catch (...) {
+			traits::deallocate(a, p, n);
+			throw;
+		}
+		return p;
+	}
+	// Allocates newSize slots. The first count come from src[0, count), the rest are filled as requested.
+	// src (oldSize slots) is released afterwards. On an exception src is left untouched.
+	static T* grow(Allocator& a, T* src, std::size_t oldSize, std::size_t count, std::size_t newSize,
+		SJCFill fill = SJCFill::ForOverwrite)
+	{
+		if constexpr (allocatorGrows) {
+			T* p = a.reallocate(src, oldSize, count, newSize);
+			construct(a, p + count, newSize - count, fill);
+			return p;
+		}
+		T* p = relocate(a, src, oldSize, count, newSize, fill);
+		if (src != nullptr) traits::deallocate(a, src, oldSize);
+		return p;
+	}
+	// Like grow(), but src is only destroyed, not freed: the caller owns its memory (e.g. inline storage).
+	static T* relocate(Allocator& a, T* src, std::size_t oldSize, std::size_t count, std::size_t newSize,
+		SJCFill fill = SJCFill::ForOverwrite)
+	{
+		T* p = traits::allocate(a, newSize);
+		try {
+			moveInto(a, src, oldSize, count, p, newSize, fill);
+		}
+		catch (...) {
+			traits::deallocate(a, p, newSize);
+			throw;
+		}
+		return p;
+	}
+	// The functions below construct into memory the caller owns (a heap buffer or inline storage)
+	// and never allocate or free it.
+	// Constructs n slots at dst: the first count are copies of src[0, count), the rest are default-initialized.
+	static void copyInto(Allocator& a, const T* src, std::size_t count, T* dst, std::size_t n)
+	{
+		std::size_t i = 0;
+		try {
+			if constexpr (triviallyCopyable) {
+				if (count > 0) std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+				i = count;
+			}
+			else {
+				for (; i < count; i++) traits::construct(a, dst + i, src[i]);
+			}
+			construct(a, dst + count, n - count, SJCFill::ForOverwrite);
+		}
+		catch (...) {
+			destroy(a, dst, i);
+			throw;
+		}
+	}
+	// Constructs newSize slots at dst: the first count come from src[0, count), the rest are filled as
+	// requested. Then destroys the oldSize slots of src. On an exception nothing is left constructed at dst.
+	static void moveInto(Allocator& a, T* src, std::size_t oldSize, std::size_t count, T* dst, std::size_t newSize,
+		SJCFill fill = SJCFill::ForOverwrite)
+	{
+		// The fill goes first, so a throwing fill leaves src as it was
+		construct(a, dst + count, newSize - count, fill);
+		if constexpr (triviallyRelocatable) {
+			if (count > 0) std::memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+			// Relocated elements now live in dst, so only the ones left behind are destroyed
+			destroy(a, src + count, oldSize - count);
+		}
+		else {
+			std::size_t i = 0;
+			try {
+				for (; i < count; i++) traits::construct(a, dst + i, std::move_if_noexcept(src[i]));
+			}
+			catch (...) {
+				destroy(a, dst, i);
+				destroy(a, dst + count, newSize - count);
+				throw;
+			}
+			destroy(a, src, oldSize);
+		}
+	}
+	// Like grow(), for a ring buffer whose count items start at src[first] and wrap around to src[0].
+	// The new buffer is linear (item i lands in slot i), so trivially relocatable items take at most two memcpy.
+	static T* growRing(Allocator& a, T* src, std::size_t oldSize, std::size_t first, std::size_t count,
+		std::size_t newSize, SJCFill fill = SJCFill::ForOverwrite)
+	{
+		// Items src[first, first + head) run up to the end of the buffer, the other count - head wrapped
+		const std::size_t head = std::min(count, oldSize - first);
+		T* p = traits::allocate(a, newSize);
+		try {
+			construct(a, p + count, newSize - count, fill);
+		}
+		catch (...) {
+			traits::deallocate(a, p, newSize);
+			throw;
+		}
+		if constexpr (triviallyRelocatable) {
+			if (head > 0) std::memcpy(static_cast<void*>(p), src + first, head * sizeof(T));
+			if (count > head) std::memcpy(static_cast<void*>(p + head), src, (count - head) * sizeof(T));
+			// Only the free slots are left behind
+			if (head == count) {
+				destroy(a, src + first + count, oldSize - first - count);
+				destroy(a, src, first);
+			}
+			else destroy(a, src + count - head, oldSize - count);
+		}
+		else {
+			std::size_t i = 0;
+			try {
+				for (; i < count; i++) {
+					const std::size_t from = i < head ? first + i : i - head;
+					traits::construct(a, p + i, std::move_if_noexcept(src[from]));
+				}
+			}
+			catch (...) {
+				destroy(a, p, i);
+				destroy(a, p + count, newSize - count);
+				traits::deallocate(a, p, newSize);
+				throw;
+			}
+			destroy(a, src, oldSize);
+		}
+		if (src != nullptr) traits::deallocate(a, src, oldSize);
+		return p;
+	}
+	// Bytes of element data that grow() copies. Zero when the allocator remaps instead.
+	static std::size_t growCopyBytes(std::size_t oldSize, std::size_t count, std::size_t newSize) noexcept
+	{
+		if constexpr (allocatorGrows) {
+			if (Allocator::remaps(oldSize, newSize)) return 0;
+		}
+		return count * sizeof(T);
+	}
+	// Destroys and frees n slots.
+	static void release(Allocator& a, T* p, std::size_t n) noexcept
+	{
+		if (p == nullptr) return;
+		destroy(a, p, n);
+		traits::deallocate(a, p, n);
+	}
+	static void destroy(Allocator& a, T* p, std::size_t n) noexcept
+	{
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			for (std::size_t i = 0; i < n; i++) traits::destroy(a, p + i);
+		}
+	}
+	// Constructs n slots at p, filled as requested
+	static void construct(Allocator& a, T* p, std::size_t n, SJCFill fill)
+	{
+		if constexpr (std::is_trivial_v<T>) {
+			// Default-initializing a trivial type writes nothing
+			if (fill == SJCFill::Zero) std::uninitialized_value_construct_n(p, n);
+		}
+		else {
+			std::size_t i = 0;
+			try {
+				for (; i < n; i++) traits::construct(a, p + i);
+			}
+			catch (...) {
+				destroy(a, p, i);
+				throw;
+			}
+		}
+	}
+};
+
+// Raw, suitably aligned room for N elements inside an object. Empty when N is 0, so a class that
+// derives from it pays nothing for inline storage it does not use.
+template <typename T, std::size_t N>
+class SJCInlineStorage {
+	alignas(T) unsigned char bytes_[N * sizeof(T)];
+public:
+	T* inlineData() noexcept { return reinterpret_cast<T*>(bytes_); }
+	const T* inlineData() const noexcept { return reinterpret_cast<const T*>(bytes_); }
+};
+template <typename T>
+class SJCInlineStorage<T, 0> {
+public:
+	T* inlineData() noexcept { return nullptr; }
+	const T* inlineData() const noexcept { return nullptr; }
+};
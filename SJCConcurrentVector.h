@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "SJCSegmentedVector.h"
+#include "SJCVectorStats.h"
+
+// CONCURRENT APPEND
+// =================
+// BasicSJCConcurrentVector lets any number of threads push_back at once without a lock.
+// A producer reserves its slot with one fetch_add on reserved_, so producers never wait for each other.
+// Storage is segmented with geometric chunks (see SJCSegmentedVector.h): growth never moves an item, and the
+// directory has a fixed number of entries, so nothing a reader may be looking at is ever reallocated.
+// The first producer to need a chunk marks it as being installed with a compare-exchange, then allocates the
+// chunk and its bitmap. Producers that need the same chunk meanwhile wait for it, so no chunk is allocated twice.
+// Reserved slots are filled in any order, so a producer marks its slot ready in a per-chunk bitmap and then
+// moves published_ forward over every ready slot it finds, in one step. size() is published_: items [0, size()) are
+// complete and visible to any thread that called size(), even while producers keep appending.
+// Concurrent objects are not copyable or movable, so those special member functions are deleted (see the
+// NON-COPYABLE note in SJCVector.h).
+// push_back reports no trace events: a shared counter there would bring back the contention point.
+// The allocator must be safe to call from several threads at once. If a chunk cannot be allocated the
+// push_back throws, and its slot, which is never filled, stops size() from growing any further.
+template <typename T = int, typename Allocator = std::allocator<T>, typename TracePolicy = SilentTrace,
+	std::size_t FirstChunkShift = 10>
+class BasicSJCConcurrentVector : private SJCTraced<BasicSJCConcurrentVector<T, Allocator, TracePolicy, FirstChunkShift>, TracePolicy> {
+	static_assert(std::is_nothrow_move_constructible_v<T>, "A slot whose construction throws would never be published");
+	using Traced = SJCTraced<BasicSJCConcurrentVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+	using Layout = SJCGeometricChunks<FirstChunkShift>;
+	using traits = std::allocator_traits<Allocator>;
+	using Word = std::atomic<std::uint64_t>;
+	using WordAllocator = typename traits::template rebind_alloc<Word>;
+	using WordTraits = std::allocator_traits<WordAllocator>;
+	// Enough chunks to cover every index a size_t can hold
+	static constexpr std::size_t maxChunks = sizeof(std::size_t) * 8 - FirstChunkShift;
+
+	std::atomic<T*> items_[maxChunks]{};		// items_[k] holds Layout::chunkSize(k) slots, installing() while allocated
+	std::atomic<Word*> ready_[maxChunks]{};		// One bit per slot of items_[k], stored before items_[k]
+	std::atomic<std::size_t> reserved_{ 0 };	// Slots handed out to producers
+	std::atomic<std::size_t> published_{ 0 };	// Items [0, published_) are complete
+	std::string name_{ "unnamed" };
+	Allocator alloc_{};
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+
+	BasicSJCConcurrentVector() {
+		trace(SJCEvent::DefaultCtor, "Concurrent ctor\n");
+	}
+	BasicSJCConcurrentVector(std::string name, const Allocator& alloc = Allocator()) : name_(std::move(name)), alloc_(alloc) {
+		trace(SJCEvent::NamedCtor, "Concurrent ctor with name ", name_, '\n');
+	}
+	// Producers must have finished before the vector is destroyed
+	~BasicSJCConcurrentVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		const std::size_t reserved = reserved_.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < reserved; i++) {
+			if (ready(i)) traits::destroy(alloc_, &(*this)[i]);
+		}
+		WordAllocator wordAlloc(alloc_);
+		for (std::size_t k = 0; k < maxChunks; k++) {
+			if (T* p = items_[k].load(std::memory_order_relaxed)) traits::deallocate(alloc_, p, Layout::chunkSize(k));
+			if (Word* w = ready_[k].load(std::memory_order_relaxed)) WordTraits::deallocate(wordAlloc, w, words(k));
+		}
+	}
+	BasicSJCConcurrentVector(const BasicSJCConcurrentVector&) = delete;
+	BasicSJCConcurrentVector& operator=(const BasicSJCConcurrentVector&) = delete;
+
+	// Safe from any number of threads at once. Returns the index of the new item, which becomes visible
+	// through size() once every item before it is complete too.
+	std::size_t push_back(T newValue) {
+		const std::size_t i = reserved_.fetch_add(1, std::memory_order_relaxed);
+		const std::size_t k = Layout::chunkOf(i);
+		const std::size_t offset = Layout::offsetOf(i);
+		T* items = chunk(k);
+		Word* ready = ready_[k].load(std::memory_order_relaxed);	// Stored before items_[k], which chunk() acquired
+		traits::construct(alloc_, items + offset, std::move(newValue));
+		// Sequentially consistent, like every access to ready_ and published_ in ready() and publish(), so
+		// they all fall in one total order. Either this producer's publish() sees published_ already at
+		// its slot, or the producer that moved published_ there reads ready_[k] and this bit after the
+		// fetch_or, and publishes the slot itself. No slot is left ready but unpublished.
+		ready[offset / 64].fetch_or(std::uint64_t{ 1 } << (offset % 64));
+		publish();
+		return i;
+	}
+
+	// Only indexes below size() are complete
+	T& operator[](std::size_t i) noexcept { return items_[Layout::chunkOf(i)].load(std::memory_order_acquire)[Layout::offsetOf(i)]; }
+	const T& operator[](std::size_t i) const noexcept { return items_[Layout::chunkOf(i)].load(std::memory_order_acquire)[Layout::offsetOf(i)]; }
+	std::size_t size() const noexcept { return published_.load(std::memory_order_acquire); }
+	bool empty() const noexcept { return size() == 0; }
+	allocator_type get_allocator() const { return alloc_; }
+	const std::string& name() const noexcept { return name_; }
+
+private:
+	static std::size_t words(std::size_t k) noexcept { return (Layout::chunkSize(k) + 63) / 64; }
+	// Both loads are sequentially consistent (see push_back). An acquire load of the bitmap pointer could
+	// still read nullptr after the producer that set the bit has read an old published_, and the slot would
+	// never be published.
+	bool ready(std::size_t i) const noexcept {
+		const Word* w = ready_[Layout::chunkOf(i)].load();
+		const std::size_t offset = Layout::offsetOf(i);
+		return w != nullptr && (w[offset / 64].load() & (std::uint64_t{ 1 } << (offset % 64))) != 0;
+	}
+	// Moves published_ over every ready slot, a whole run of them per compare-exchange. Any producer may move
+	// it past slots of other producers.
+	void publish() noexcept {
+		std::size_t p = published_.load();
+		for (;;) {
+			std::size_t end = p;
+			while (ready(end)) end++;
+			if (end == p) return;
+			// On failure p is reloaded and the run is measured again from wherever published_ is now.
+			// On success the loop looks once more for slots that became ready during the scan.
+			if (published_.compare_exchange_weak(p, end)) p = end;
+		}
+	}
+	// Marks a chunk whose producer is still allocating it. Never dereferenced.
+	static T* installing() noexcept {
+		alignas(T) static unsigned char mark[sizeof(T)];
+		return reinterpret_cast<T*>(mark);
+	}
+	// Returns chunk k. The producer that swaps nullptr for installing() allocates it, the others wait until
+	// it is installed (or reset to nullptr, if the allocation threw, for one of them to try again).
+	T* chunk(std::size_t k) {
+		T* p = items_[k].load(std::memory_order_acquire);
+		while (p == nullptr || p == installing()) {
+			if (p == installing()) {
+				std::this_thread::yield();
+				p = items_[k].load(std::memory_order_acquire);
+			}
+			else if (items_[k].compare_exchange_weak(p, installing(), std::memory_order_relaxed, std::memory_order_acquire)) {
+				return allocateChunk(k);
+			}
+		}
+		return p;
+	}
+	T* allocateChunk(std::size_t k) {
+		WordAllocator wordAlloc(alloc_);
+		Word* w = nullptr;
+		T* p = nullptr;
+		try {
+			w = WordTraits::allocate(wordAlloc, words(k));
+			p = traits::allocate(alloc_, Layout::chunkSize(k));
+		}
+		catch (...) {
+			if (w != nullptr) WordTraits::deallocate(wordAlloc, w, words(k));
+			items_[k].store(nullptr, std::memory_order_release);
+			throw;
+		}
+		for (std::size_t j = 0; j < words(k); j++) WordTraits::construct(wordAlloc, w + j, std::uint64_t{ 0 });
+		ready_[k].store(w);		// Sequentially consistent, see ready()
+		items_[k].store(p, std::memory_order_release);
+		record(SJCEvent::Allocate, Layout::chunkSize(k) * sizeof(T) + words(k) * sizeof(Word));
+		return p;
+	}
+};
+
+template <typename T>
+using SJCConcurrentVectorOf = BasicSJCConcurrentVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY>;
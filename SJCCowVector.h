@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "SJCVector.h"
+
+// COPY ON WRITE
+// =============
+// SJCCowVector<Vec> is the opt-in copy-on-write form of any SJCVector type. Copies share one buffer, so copying
+// is a reference count increment however big the vector is. The deep copy (Vec's copy constructor) happens
+// on the first mutating call made through a copy that is still shared: push_back, resize, rename, non-const
+// operator[] or data(), or edit().
+// Non-const operator[] cannot tell a read from a write, so it always unshares. Read through a const
+// reference (or get()) to keep sharing.
+// The reference count is atomic: copies may be handed to other threads and destroyed or written there. As with
+// any object, one SJCCowVector must not be mutated by one thread while another uses it.
+// The count is the class's own rather than std::shared_ptr's: use_count() is a relaxed load, so a copy that
+// saw the count drop to 1 could write in place while the thread that dropped it was still reading the buffer
+// for its deep copy. Here owners leave with acq_rel and edit() reads the count with acquire, so every other
+// owner's reads happen before the write.
+// RULE OF FOUR AND A HALF: the count is managed by hand, with a by-value assignment operator and swap.
+// A default-constructed or moved-from SJCCowVector holds no buffer at all and reads as empty.
+template <typename Vec = SJCVector>
+class SJCCowVector {
+	// One buffer and the number of SJCCowVectors that share it
+	struct Shared {
+		std::atomic<std::size_t> owners{ 1 };
+		Vec vec;
+		explicit Shared(Vec v) : vec(std::move(v)) {}
+	};
+	Shared* shared_ = nullptr;
+
+public:
+	using vector_type = Vec;
+	using value_type = typename Vec::value_type;
+
+	SJCCowVector() = default;
+	explicit SJCCowVector(Vec vec) : shared_(new Shared(std::move(vec))) {}
+	// Relaxed: rhs is an owner, so the buffer cannot go away while the count goes up
+	SJCCowVector(const SJCCowVector& rhs) noexcept : shared_(rhs.shared_) {
+		if (shared_ != nullptr) shared_->owners.fetch_add(1, std::memory_order_relaxed);
+	}
+	SJCCowVector(SJCCowVector&& rhs) noexcept : shared_(std::exchange(rhs.shared_, nullptr)) {}
+	SJCCowVector& operator=(SJCCowVector rhs) noexcept {
+		rhs.swap(*this);
+		return *this;
+	}
+	~SJCCowVector() {
+		leave();
+	}
+	void swap(SJCCowVector& rhs) noexcept {
+		std::swap(shared_, rhs.shared_);
+	}
+	friend void swap(SJCCowVector& a, SJCCowVector& b) noexcept {
+		a.swap(b);
+	}
+
+	// Reads never copy
+	const Vec& get() const { return shared_ != nullptr ? shared_->vec : none(); }
+	const value_type& operator[](std::size_t i) const { return get()[i]; }
+	const value_type* data() const { return get().data(); }
+	std::size_t size() const { return get().size(); }
+	std::size_t capacity() const { return get().capacity(); }
+	bool empty() const { return get().empty(); }
+	const std::string& name() const { return get().name(); }
+	// True if other copies share the buffer
+	bool shared() const noexcept { return shared_ != nullptr && shared_->owners.load(std::memory_order_acquire) > 1; }
+
+	// Writes get a buffer of their own first
+	// A count of 1 read with acquire means the other owners have left, and their reads are done
+	Vec& edit() {
+		if (shared_ == nullptr) shared_ = new Shared(Vec());
+		else if (shared_->owners.load(std::memory_order_acquire) > 1) {
+			Shared* own = new Shared(shared_->vec);	// The deferred deep copy
+			leave();
+			shared_ = own;
+		}
+		return shared_->vec;
+	}
+	value_type& operator[](std::size_t i) { return edit()[i]; }
+	value_type* data() { return edit().data(); }
+	void push_back(value_type newValue) { edit().push_back(std::move(newValue)); }
+	void resize(std::size_t newSize, SJCFill fill = SJCFill::ForOverwrite) { edit().resize(newSize, fill); }
+	void rename(std::string newName) { edit().rename(std::move(newName)); }
+
+private:
+	// Release publishes this owner's reads of the buffer to the next writer, acquire lets the last owner see
+	// everyone's before it deletes
+	void leave() noexcept {
+		if (shared_ != nullptr && shared_->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) delete shared_;
+		shared_ = nullptr;
+	}
+	// What a vector without a buffer reads as
+	static const Vec& none() {
+		static const Vec empty;
+		return empty;
+	}
+};
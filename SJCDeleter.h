@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+// BUFFER DELETERS
+// ===============
+// SJCDeleter<T> gives back the memory of a buffer that did not come from the vector's own allocator: one handed
+// over by a decoder, a mapping of shared memory, a pool (see BasicSJCVector::adopt). It is the deallocate half of
+// an allocator: the vector destroys the slots first, then calls the deleter once with the buffer and its
+// capacity in slots.
+// It is a function pointer and a context pointer, so it is two words and trivially copyable. Only allocator(a)
+// with a stateful allocator allocates, for the copy of the allocator.
+// SJCDeleter<T>::free()             - memory from std::malloc
+// SJCDeleter<T>::unmap()            - a mapping (mmap) that starts at the buffer and covers its capacity (POSIX)
+// SJCDeleter<T>::pool<Pool>()       - memory from Pool::allocate(bytes), e.g. SJCBufferPool<N> (see SJCPoolAllocator.h)
+// SJCDeleter<T>::allocator<A>()     - memory from a stateless allocator A
+// SJCDeleter<T>::allocator(a)       - memory from a (a copy of it is kept until the deleter runs)
+// SJCDeleter<T>(function, context)  - anything else: function(buffer, capacity, context)
+// A default-constructed SJCDeleter is empty: the buffer belongs to the vector's allocator.
+//		int* p = static_cast<int*>(std::malloc(n * sizeof(int)));
+//		v.adopt(p, n, n, SJCDeleter<int>::free());
+
+template <typename T>
+class SJCDeleter {
+public:
+	using Function = void (*)(T* buffer, std::size_t capacity, void* context);
+
+	SJCDeleter() = default;
+	SJCDeleter(Function function, void* context = nullptr) noexcept : function_(function), context_(context) {}
+
+	static SJCDeleter free() noexcept
+	{
+		return SJCDeleter([](T* p, std::size_t, void*) { std::free(p); });
+	}
+#if !defined(_WIN32)
+	static SJCDeleter unmap() noexcept
+	{
+		return SJCDeleter([](T* p, std::size_t n, void*) { ::munmap(p, n * sizeof(T)); });
+	}
+#endif
+	template <typename Pool>
+	static SJCDeleter pool() noexcept
+	{
+		return SJCDeleter([](T* p, std::size_t n, void*) { Pool::deallocate(p, n * sizeof(T)); });
+	}
+	// Frees with a new instance of A, so only an allocator whose instances are all equal will do
+	template <typename Allocator>
+	static SJCDeleter allocator() noexcept
+	{
+		using A = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+		static_assert(std::allocator_traits<A>::is_always_equal::value && std::is_default_constructible_v<A>,
+			"Only a stateless allocator can free memory another instance allocated");
+		return SJCDeleter([](T* p, std::size_t n, void*) {
+			A a;
+			std::allocator_traits<A>::deallocate(a, p, n);
+		});
+	}
+	// Any allocator. A stateful one (e.g. std::pmr::polymorphic_allocator) is copied to the heap as the
+	// context, which the deleter frees after the buffer, so the deleter must run exactly once. Whatever the
+	// copy refers to (a pmr memory resource) must outlive the buffer.
+	template <typename Allocator>
+	static SJCDeleter allocator(const Allocator& alloc)
+	{
+		using A = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+		if constexpr (std::allocator_traits<A>::is_always_equal::value && std::is_default_constructible_v<A>) {
+			return allocator<Allocator>();
+		}
+		else {
+			return SJCDeleter([](T* p, std::size_t n, void* context) {
+				A* a = static_cast<A*>(context);
+				std::allocator_traits<A>::deallocate(*a, p, n);
+				delete a;
+			}, new A(alloc));
+		}
+	}
+
+	explicit operator bool() const noexcept { return function_ != nullptr; }
+	void* context() const noexcept { return context_; }
+	// A null buffer is never passed on
+	void operator()(T* buffer, std::size_t capacity) const noexcept
+	{
+		if (buffer != nullptr) function_(buffer, capacity, context_);
+	}
+
+private:
+	Function function_ = nullptr;
+	void* context_ = nullptr;
+};
+
+// A buffer handed out by BasicSJCVector::release(). Its capacity slots are live T and the first size of them
+// are the items. The holder owns it: pass it to another vector's adopt(), or destroy the slots (nothing to do
+// for trivially destructible T) and call deleter(data, capacity).
+template <typename T>
+struct SJCReleasedBuffer {
+	T* data = nullptr;
+	std::size_t size = 0;
+	std::size_t capacity = 0;
+	SJCDeleter<T> deleter;
+};
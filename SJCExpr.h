@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// EXPRESSION TEMPLATES
+// ====================
+// a + b + c + d with an eager operator+ allocates and walks memory three times and leaves three temporaries.
+// Here +, - and * on vectors (and on scalars broadcast against vectors), sjcMin, sjcMax, sjcEqual and
+// sjcGreater do no work at all. They return a small expression object that records the operation and
+// refers to the operands' buffers.
+// The work happens when a vector is constructed from, or assigned, the expression: one allocation (none if
+// the destination already has room) and one fused loop over all operands, which the compiler can vectorize.
+//		SJCVector r(a + b * 2 - c);	// one pass, one allocation
+// Expressions refer to the operands' buffers, so evaluate them before those vectors change or go away.
+// Operands of different sizes (or an empty operand) give an empty result.
+// A type takes part as a vector if it has a member sjc_vector_tag and provides data() and size().
+
+template <typename T, typename = void>
+struct SJCIsVector : std::false_type {};
+template <typename T>
+struct SJCIsVector<T, std::void_t<typename T::sjc_vector_tag>> : std::true_type {};
+
+template <typename T, typename = void>
+struct SJCIsExpr : std::false_type {};
+template <typename T>
+struct SJCIsExpr<T, std::void_t<typename T::sjc_expr_tag>> : std::true_type {};
+
+// Size of a scalar operand: it matches any vector size
+inline constexpr std::size_t sjcBroadcast = std::numeric_limits<std::size_t>::max();
+
+inline constexpr std::size_t sjcCombinedSize(std::size_t l, std::size_t r) noexcept
+{
+	if (l == sjcBroadcast) return r;
+	if (r == sjcBroadcast) return l;
+	return l == r ? l : 0;
+}
+
+template <typename T>
+struct SJCExprLeaf {
+	using sjc_expr_tag = void;
+	const T* data;
+	std::size_t n;
+	const T& operator[](std::size_t i) const noexcept { return data[i]; }
+	std::size_t size() const noexcept { return n; }
+};
+
+template <typename T>
+struct SJCExprScalar {
+	using sjc_expr_tag = void;
+	T value;
+	const T& operator[](std::size_t) const noexcept { return value; }
+	std::size_t size() const noexcept { return sjcBroadcast; }
+};
+
+template <typename Op, typename L, typename R>
+struct SJCExprBinary {
+	using sjc_expr_tag = void;
+	L l;
+	R r;
+	auto operator[](std::size_t i) const { return Op::apply(l[i], r[i]); }
+	std::size_t size() const noexcept { return sjcCombinedSize(l.size(), r.size()); }
+};
+
+struct SJCPlus {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a + b; }
+};
+struct SJCMinus {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a - b; }
+};
+struct SJCMultiplies {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a * b; }
+};
+
+struct SJCMin {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return b < a ? b : a; }
+};
+struct SJCMax {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a < b ? b : a; }
+};
+// Comparisons give 1 where true and 0 where false
+struct SJCEqual {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a == b; }
+};
+struct SJCGreater {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) { return a > b; }
+};
+
+// Wraps a vector, expression or scalar so it can sit inside an expression. Expressions are copied,
+// they only hold pointers and sizes.
+template <typename X>
+auto sjcOperand(const X& x)
+{
+	if constexpr (SJCIsExpr<X>::value) return x;
+	else if constexpr (SJCIsVector<X>::value) return SJCExprLeaf<typename X::value_type>{ x.data(), x.size() };
+	else return SJCExprScalar<X>{ x };
+}
+
+template <typename X>
+inline constexpr bool sjcIsExprOperand = SJCIsVector<X>::value || SJCIsExpr<X>::value;
+
+// At least one side must be a vector or an expression, the other may also be a scalar
+template <typename L, typename R>
+inline constexpr bool sjcIsExprPair = (sjcIsExprOperand<L> && (sjcIsExprOperand<R> || std::is_arithmetic_v<R>))
+	|| (std::is_arithmetic_v<L> && sjcIsExprOperand<R>);
+
+template <typename Op, typename L, typename R>
+auto sjcMakeExpr(const L& l, const R& r)
+{
+	return SJCExprBinary<Op, decltype(sjcOperand(l)), decltype(sjcOperand(r))>{ sjcOperand(l), sjcOperand(r) };
+}
+
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto operator+(const L& l, const R& r) { return sjcMakeExpr<SJCPlus>(l, r); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto operator-(const L& l, const R& r) { return sjcMakeExpr<SJCMinus>(l, r); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto operator*(const L& l, const R& r) { return sjcMakeExpr<SJCMultiplies>(l, r); }
+
+// TEMPORARY OPERANDS
+// ====================
+// An expression may not outlive the vectors it refers to, and a temporary vector dies at the end of the
+// full expression. So when an operand is a temporary vector (f() + a, or std::move(v) * 2), the operator
+// evaluates straight away into that operand's buffer and returns it: no allocation and no copy, and the
+// result is itself a temporary that the next operator in a chain can reuse.
+// Taking L&& and R&& makes these overloads a better match than the const& ones above for rvalue vectors.
+template <typename X>
+inline constexpr bool sjcIsTemporaryVector = !std::is_reference_v<X> && SJCIsVector<X>::value;
+
+template <typename L, typename R>
+inline constexpr bool sjcReusesOperand = (sjcIsTemporaryVector<L> || sjcIsTemporaryVector<R>)
+	&& sjcIsExprPair<std::decay_t<L>, std::decay_t<R>>;
+
+template <typename Op, typename L, typename R>
+auto sjcEvaluateInto(L&& l, R&& r)
+{
+	if constexpr (sjcIsTemporaryVector<L>) {
+		l = sjcMakeExpr<Op>(l, r);
+		return std::move(l);
+	}
+	else {
+		r = sjcMakeExpr<Op>(l, r);
+		return std::move(r);
+	}
+}
+
+template <typename L, typename R, typename = std::enable_if_t<sjcReusesOperand<L, R>>>
+auto operator+(L&& l, R&& r) { return sjcEvaluateInto<SJCPlus>(std::forward<L>(l), std::forward<R>(r)); }
+template <typename L, typename R, typename = std::enable_if_t<sjcReusesOperand<L, R>>>
+auto operator-(L&& l, R&& r) { return sjcEvaluateInto<SJCMinus>(std::forward<L>(l), std::forward<R>(r)); }
+template <typename L, typename R, typename = std::enable_if_t<sjcReusesOperand<L, R>>>
+auto operator*(L&& l, R&& r) { return sjcEvaluateInto<SJCMultiplies>(std::forward<L>(l), std::forward<R>(r)); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto sjcMin(const L& l, const R& r) { return sjcMakeExpr<SJCMin>(l, r); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto sjcMax(const L& l, const R& r) { return sjcMakeExpr<SJCMax>(l, r); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto sjcEqual(const L& l, const R& r) { return sjcMakeExpr<SJCEqual>(l, r); }
+template <typename L, typename R, typename = std::enable_if_t<sjcIsExprPair<L, R>>>
+auto sjcGreater(const L& l, const R& r) { return sjcMakeExpr<SJCGreater>(l, r); }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// GROWTH POLICIES
+// ===============
+// push_back asks the growth policy for the new capacity when the buffer is full.
+// A policy provides:
+//		static std::size_t grow(std::size_t capacity, std::size_t elementSize) noexcept;	// must return > capacity
+// SJCDoublingGrowth      - capacity * 2 + 1, the original behaviour and the default.
+// SJCGeometricGrowth     - capacity * Num / Den + 1, e.g. SJCGrowth1_5x.
+// SJCChunkGrowth         - adds a fixed number of elements. Suits many small vectors with a known bound.
+// SJCPageGrowth          - geometric, rounded up to whole pages. Suits huge vectors.
+// SJCSizeClassGrowth     - geometric, rounded up to the next jemalloc size class so no allocator slack is wasted.
+
+template <std::size_t Num, std::size_t Den = 1>
+struct SJCGeometricGrowth {
+	static_assert(Num > Den, "SJCGeometricGrowth must grow");
+	static std::size_t grow(std::size_t capacity, std::size_t) noexcept
+	{
+		return capacity / Den * Num + capacity % Den * Num / Den + 1;
+	}
+};
+
+using SJCDoublingGrowth = SJCGeometricGrowth<2>;
+using SJCGrowth1_5x = SJCGeometricGrowth<3, 2>;
+
+template <std::size_t Chunk>
+struct SJCChunkGrowth {
+	static_assert(Chunk > 0, "SJCChunkGrowth must grow");
+	static std::size_t grow(std::size_t capacity, std::size_t) noexcept
+	{
+		return capacity + Chunk;
+	}
+};
+
+template <std::size_t PageSize = 4096, typename Base = SJCDoublingGrowth>
+struct SJCPageGrowth {
+	static std::size_t grow(std::size_t capacity, std::size_t elementSize) noexcept
+	{
+		const std::size_t bytes = Base::grow(capacity, elementSize) * elementSize;
+		const std::size_t pages = (bytes + PageSize - 1) / PageSize;
+		return pages * PageSize / elementSize;
+	}
+};
+
+// Index of the highest set bit, n > 0
+inline std::size_t sjcFloorLog2(std::size_t n) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	// _BitScanReverse64 only exists on 64-bit targets, where size_t is 64 bits too
+	unsigned long bit;
+#if defined(_WIN64)
+	_BitScanReverse64(&bit, n);
+#else
+	_BitScanReverse(&bit, static_cast<unsigned long>(n));
+#endif
+	return bit;
+#else
+	return sizeof(unsigned long long) * 8 - 1 - static_cast<std::size_t>(__builtin_clzll(n));
+#endif
+}
+
+// jemalloc size classes: 8, then multiples of 16 up to 64, then four classes per doubling
+// (80, 96, 112, 128, 160, 192, 224, 256, 320...).
+inline std::size_t sjcSizeClass(std::size_t bytes) noexcept
+{
+	if (bytes <= 8) return 8;
+	if (bytes <= 64) return (bytes + 15) & ~std::size_t{ 15 };
+	const std::size_t lg = sjcFloorLog2(bytes - 1);
+	const std::size_t delta = std::size_t{ 1 } << (lg - 2);
+	return (bytes + delta - 1) & ~(delta - 1);
+}
+
+template <typename Base = SJCDoublingGrowth>
+struct SJCSizeClassGrowth {
+	static std::size_t grow(std::size_t capacity, std::size_t elementSize) noexcept
+	{
+		const std::size_t bytes = sjcSizeClass(Base::grow(capacity, elementSize) * elementSize);
+		return bytes / elementSize;
+	}
+};
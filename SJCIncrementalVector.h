@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "SJCBuffer.h"
+#include "SJCGrowthPolicy.h"
+#include "SJCVectorStats.h"
+
+// INCREMENTAL GROWTH
+// ==================
+// BasicSJCVector::push_back copies the whole buffer when it grows, so one push_back in a million costs O(n).
+// BasicSJCIncrementalVector spreads that copy out, like incremental rehashing in a hash table:
+// when the buffer is full a new one is allocated, the old one is kept, and every later push_back or
+// non-const operator[] migrates at most MigrateStep items from the old buffer to the new one.
+// No single operation copies more than MigrateStep items, except when the buffer fills up again before
+// the previous migration is done (MigrateStep >= 2 with any growth of 1.5x or more prevents that).
+// Reads during a migration check which buffer holds the item, so they cost one extra compare.
+// Unlike BasicSJCVector, only the items are live objects. Free slots are raw memory, so allocating the
+// new buffer does not touch it.
+template <typename T = int, typename Allocator = std::allocator<T>, typename TracePolicy = SilentTrace,
+	typename GrowthPolicy = SJCDoublingGrowth, std::size_t MigrateStep = 64>
+class BasicSJCIncrementalVector : private SJCTraced<BasicSJCIncrementalVector<T, Allocator, TracePolicy, GrowthPolicy, MigrateStep>, TracePolicy> {
+	static_assert(MigrateStep > 0, "BasicSJCIncrementalVector must migrate at least one item per step");
+	using traits = std::allocator_traits<Allocator>;
+	using Traced = SJCTraced<BasicSJCIncrementalVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+	static constexpr bool swapsAllocator = traits::propagate_on_container_swap::value;
+	static constexpr bool alwaysEqual = traits::is_always_equal::value;
+
+	T* ptr_ = nullptr;				// New (or only) buffer
+	size_t size_{ 0 };				// Slots in ptr_
+	long long last_{ -1 };			// Index of the last item
+	T* old_ = nullptr;				// Buffer being migrated from, nullptr when not migrating
+	size_t oldSize_{ 0 };			// Slots in old_
+	size_t oldCount_{ 0 };			// Items that were in old_ when the migration started
+	size_t migrated_{ 0 };			// Items [0, migrated_) have moved to ptr_
+	std::string name_{ "unnamed" };
+	Allocator alloc_{};
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+
+	BasicSJCIncrementalVector() {
+		trace(SJCEvent::DefaultCtor, "Incremental ctor\n");
+	}
+	BasicSJCIncrementalVector(std::string name, const Allocator& alloc = Allocator()) : name_(std::move(name)), alloc_(alloc) {
+		trace(SJCEvent::NamedCtor, "Incremental ctor with name ", name_, '\n');
+	}
+	~BasicSJCIncrementalVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		clear();
+	}
+	// Copies end up in a single buffer, there is nothing to migrate
+	BasicSJCIncrementalVector(const BasicSJCIncrementalVector& rhs)
+		: alloc_(traits::select_on_container_copy_construction(rhs.alloc_)) {
+		trace(SJCEvent::CopyCtor, "Incremental copy ctor from ", SJCName{ rhs.name_ }, '\n');
+		const size_t count = rhs.size();
+		if (count == 0) return;
+		ptr_ = traits::allocate(alloc_, count);
+		size_ = count;
+		record(SJCEvent::Allocate, count * sizeof(T));
+		try {
+			for (; static_cast<size_t>(last_ + 1) < count; last_++) traits::construct(alloc_, ptr_ + last_ + 1, rhs[last_ + 1]);
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+		record(SJCEvent::CopyData, count * sizeof(T));
+	}
+	BasicSJCIncrementalVector(BasicSJCIncrementalVector&& rhs) noexcept : alloc_(std::move(rhs.alloc_)) {
+		trace(SJCEvent::MoveCtor, "Incremental move ctor. Stole guts of rvalue: ", SJCName{ rhs.name_ }, '\n');
+		ptr_ = std::exchange(rhs.ptr_, nullptr);
+		size_ = std::exchange(rhs.size_, 0);
+		last_ = std::exchange(rhs.last_, -1);
+		old_ = std::exchange(rhs.old_, nullptr);
+		oldSize_ = std::exchange(rhs.oldSize_, 0);
+		oldCount_ = std::exchange(rhs.oldCount_, 0);
+		migrated_ = std::exchange(rhs.migrated_, 0);
+	}
+	// A copy in memory from another allocator that does not propagate on swap has its items moved over instead
+	BasicSJCIncrementalVector& operator=(BasicSJCIncrementalVector copy) noexcept(swapsAllocator || alwaysEqual) {
+		trace(SJCEvent::ByValueAssign, "Incremental by-value assignment (=) operator\n");
+		if constexpr (!swapsAllocator && !alwaysEqual) {
+			if (!(alloc_ == copy.alloc_)) {
+				clear();
+				for (size_t i = 0; i < copy.size(); i++) push_back(std::move(copy[i]));
+				return *this;
+			}
+		}
+		copy.swap(*this);
+		return *this;
+	}
+	// The allocators are swapped only if they propagate on swap, otherwise they must be equal (as for std::vector)
+	void swap(BasicSJCIncrementalVector& rhs) noexcept {
+		record(SJCEvent::Swap);
+		assert(swapsAllocator || alloc_ == rhs.alloc_);
+		using std::swap;
+		swap(ptr_, rhs.ptr_);
+		swap(size_, rhs.size_);
+		swap(last_, rhs.last_);
+		swap(old_, rhs.old_);
+		swap(oldSize_, rhs.oldSize_);
+		swap(oldCount_, rhs.oldCount_);
+		swap(migrated_, rhs.migrated_);
+		if constexpr (swapsAllocator) swap(alloc_, rhs.alloc_);
+	}
+	friend void swap(BasicSJCIncrementalVector& a, BasicSJCIncrementalVector& b) noexcept {
+		a.swap(b);
+	}
+
+	// Non-const access moves the migration along, const access only looks
+	T& operator[](std::size_t i) {
+		migrate();
+		return *slot(i);
+	}
+	const T& operator[](std::size_t i) const noexcept { return *slot(i); }
+	std::size_t size() const noexcept { return static_cast<std::size_t>(last_ + 1); }
+	std::size_t capacity() const noexcept { return size_; }
+	bool empty() const noexcept { return last_ < 0; }
+	bool migrating() const noexcept { return old_ != nullptr; }
+	const std::string& name() const noexcept { return name_; }
+
+	void push_back(T newValue) {
+		record(SJCEvent::PushBack);
+		migrate();
+		if (size() == size_) grow();
+		traits::construct(alloc_, ptr_ + last_ + 1, std::move(newValue));
+		last_++;
+	}
+	// Completes a pending migration in one go
+	void finishMigration() {
+		while (old_ != nullptr) migrate();
+	}
+
+private:
+	T* slot(std::size_t i) const noexcept {
+		if (i >= migrated_ && i < oldCount_ && old_ != nullptr) return old_ + i;
+		return ptr_ + i;
+	}
+	void grow() {
+		// A migration still in flight is finished first, only two buffers ever coexist
+		finishMigration();
+		const size_t newSize = GrowthPolicy::grow(size_, sizeof(T));
+		T* newptr = traits::allocate(alloc_, newSize);
+		record(SJCEvent::Allocate, newSize * sizeof(T));
+		old_ = std::exchange(ptr_, newptr);
+		oldSize_ = std::exchange(size_, newSize);
+		oldCount_ = size();
+		migrated_ = 0;
+		trace(SJCEvent::Resize, "Incremental resize of ", SJCName{ name_ }, "to ", size_, ", migrating ", oldCount_, " items\n");
+		if (oldCount_ == 0) releaseOld();
+	}
+	// Moves up to MigrateStep items from old_ to ptr_
+	void migrate() {
+		if (old_ == nullptr) return;
+		const size_t end = std::min(oldCount_, migrated_ + MigrateStep);
+		const size_t begin = migrated_;
+		if constexpr (SJCBuffer<Allocator>::triviallyRelocatable) {
+			std::memcpy(static_cast<void*>(ptr_ + begin), old_ + begin, (end - begin) * sizeof(T));
+			migrated_ = end;
+		}
+		else {
+			for (; migrated_ < end; migrated_++) {
+				traits::construct(alloc_, ptr_ + migrated_, std::move_if_noexcept(old_[migrated_]));
+				traits::destroy(alloc_, old_ + migrated_);
+			}
+		}
+		record(SJCEvent::CopyData, (end - begin) * sizeof(T));
+		if (migrated_ == oldCount_) releaseOld();
+	}
+	void releaseOld() noexcept {
+		if (old_ != nullptr) traits::deallocate(alloc_, old_, oldSize_);	// null after the first grow
+		old_ = nullptr;
+		oldSize_ = oldCount_ = migrated_ = 0;
+	}
+	void clear() noexcept {
+		for (size_t i = 0; i < size(); i++) SJCBuffer<Allocator>::destroy(alloc_, slot(i), 1);
+		if (old_ != nullptr) releaseOld();
+		if (ptr_ != nullptr) traits::deallocate(alloc_, ptr_, size_);
+		ptr_ = nullptr;
+		size_ = 0;
+		last_ = -1;
+	}
+};
+
+template <typename T, std::size_t MigrateStep = 64>
+using SJCIncrementalVectorOf = BasicSJCIncrementalVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY, SJCDoublingGrowth, MigrateStep>;
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstddef>
+
+#include "SJCExpr.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SJC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define SJC_X86 0
+#endif
+
+// Lets GCC and clang compile a function for an instruction set the rest of the program may not assume.
+// MSVC compiles any intrinsic without a flag.
+#if defined(__GNUC__) || defined(__clang__)
+#define SJC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SJC_TARGET(isa)
+#endif
+
+// ELEMENT-WISE KERNELS
+// ====================
+// add, sub, mul, min, max, equal and greater over two int buffers, with SSE2, AVX2 and AVX-512
+// implementations and a scalar fallback. sjcKernels() picks the widest one the CPU supports the first
+// time it is called (CPUID), so one binary runs well everywhere.
+// Arithmetic wraps on overflow, comparisons give 1 or 0, like the scalar expression code.
+// BasicSJCVector<int> uses the kernels when an expression is a single operation on two vectors,
+// e.g. r = a + b or r = sjcMin(a, b). Longer expressions stay in the fused expression loop.
+
+using SJCBinaryKernel = void (*)(const int* a, const int* b, int* out, std::size_t n);
+
+struct SJCKernelTable {
+	const char* isa;
+	SJCBinaryKernel add;
+	SJCBinaryKernel sub;
+	SJCBinaryKernel mul;
+	SJCBinaryKernel min;
+	SJCBinaryKernel max;
+	SJCBinaryKernel equal;
+	SJCBinaryKernel greater;
+};
+
+enum class SJCIsa { Scalar, SSE2, AVX2, AVX512 };
+
+// OPERATIONS
+// ============
+// One struct per operation, with a scalar version and one per instruction set
+
+struct SJCKernelAdd {
+	static int scalar(int a, int b) noexcept { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); }
+#if SJC_X86
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_add_epi32(a, b); }
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_add_epi32(a, b); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_add_epi32(a, b); }
+#endif
+};
+struct SJCKernelSub {
+	static int scalar(int a, int b) noexcept { return static_cast<int>(static_cast<unsigned>(a) - static_cast<unsigned>(b)); }
+#if SJC_X86
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_sub_epi32(a, b); }
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_sub_epi32(a, b); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_sub_epi32(a, b); }
+#endif
+};
+struct SJCKernelMul {
+	static int scalar(int a, int b) noexcept { return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b)); }
+#if SJC_X86
+	// SSE2 has no 32-bit low multiply: multiply even and odd lanes as 64-bit and interleave the low halves
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept
+	{
+		const __m128i even = _mm_mul_epu32(a, b);
+		const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_mullo_epi32(a, b); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_mullo_epi32(a, b); }
+#endif
+};
+struct SJCKernelMin {
+	static int scalar(int a, int b) noexcept { return b < a ? b : a; }
+#if SJC_X86
+	// SSE2 has no 32-bit min: select with a compare mask
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept
+	{
+		const __m128i aGreater = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(aGreater, b), _mm_andnot_si128(aGreater, a));
+	}
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_min_epi32(a, b); }
+	// The masked form avoids a GCC 12 false -Wmaybe-uninitialized in the unmasked intrinsic
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_maskz_min_epi32(0xFFFF, a, b); }
+#endif
+};
+struct SJCKernelMax {
+	static int scalar(int a, int b) noexcept { return a < b ? b : a; }
+#if SJC_X86
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept
+	{
+		const __m128i aGreater = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(aGreater, a), _mm_andnot_si128(aGreater, b));
+	}
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_max_epi32(a, b); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept { return _mm512_maskz_max_epi32(0xFFFF, a, b); }
+#endif
+};
+// Compare masks are all ones where true. Shifting right by 31 turns them into 1.
+struct SJCKernelEqual {
+	static int scalar(int a, int b) noexcept { return a == b; }
+#if SJC_X86
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_srli_epi32(_mm_cmpeq_epi32(a, b), 31); }
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_srli_epi32(_mm256_cmpeq_epi32(a, b), 31); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept
+	{
+		return _mm512_maskz_set1_epi32(_mm512_cmpeq_epi32_mask(a, b), 1);
+	}
+#endif
+};
+struct SJCKernelGreater {
+	static int scalar(int a, int b) noexcept { return a > b; }
+#if SJC_X86
+	SJC_TARGET("sse2") static __m128i sse2(__m128i a, __m128i b) noexcept { return _mm_srli_epi32(_mm_cmpgt_epi32(a, b), 31); }
+	SJC_TARGET("avx2") static __m256i avx2(__m256i a, __m256i b) noexcept { return _mm256_srli_epi32(_mm256_cmpgt_epi32(a, b), 31); }
+	SJC_TARGET("avx512f") static __m512i avx512(__m512i a, __m512i b) noexcept
+	{
+		return _mm512_maskz_set1_epi32(_mm512_cmpgt_epi32_mask(a, b), 1);
+	}
+#endif
+};
+
+// LOOPS
+// =======
+// Full vectors with unaligned loads and stores, then a scalar tail
+
+template <typename Op>
+struct SJCScalarKernel {
+	static void run(const int* a, const int* b, int* out, std::size_t n) noexcept
+	{
+		for (std::size_t i = 0; i < n; i++) out[i] = Op::scalar(a[i], b[i]);
+	}
+};
+
+#if SJC_X86
+template <typename Op>
+struct SJCSse2Kernel {
+	SJC_TARGET("sse2") static void run(const int* a, const int* b, int* out, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Op::sse2(va, vb));
+		}
+		for (; i < n; i++) out[i] = Op::scalar(a[i], b[i]);
+	}
+};
+template <typename Op>
+struct SJCAvx2Kernel {
+	SJC_TARGET("avx2") static void run(const int* a, const int* b, int* out, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+			const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Op::avx2(va, vb));
+		}
+		for (; i < n; i++) out[i] = Op::scalar(a[i], b[i]);
+	}
+};
+template <typename Op>
+struct SJCAvx512Kernel {
+	SJC_TARGET("avx512f") static void run(const int* a, const int* b, int* out, std::size_t n) noexcept
+	{
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const __m512i va = _mm512_loadu_si512(a + i);
+			const __m512i vb = _mm512_loadu_si512(b + i);
+			_mm512_storeu_si512(out + i, Op::avx512(va, vb));
+		}
+		for (; i < n; i++) out[i] = Op::scalar(a[i], b[i]);
+	}
+};
+#endif
+
+template <template <typename> class Kernel>
+constexpr SJCKernelTable sjcMakeKernelTable(const char* isa)
+{
+	return { isa,
+		&Kernel<SJCKernelAdd>::run, &Kernel<SJCKernelSub>::run, &Kernel<SJCKernelMul>::run,
+		&Kernel<SJCKernelMin>::run, &Kernel<SJCKernelMax>::run,
+		&Kernel<SJCKernelEqual>::run, &Kernel<SJCKernelGreater>::run };
+}
+
+// DISPATCH
+// ==========
+
+inline bool sjcCpuSupports(SJCIsa isa) noexcept
+{
+#if SJC_X86 && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	switch (isa) {
+	case SJCIsa::Scalar: return true;
+	case SJCIsa::SSE2: return __builtin_cpu_supports("sse2");
+	case SJCIsa::AVX2: return __builtin_cpu_supports("avx2");
+	case SJCIsa::AVX512: return __builtin_cpu_supports("avx512f");
+	}
+	return false;
+#elif SJC_X86
+	// CPUID says what the CPU has, XGETBV whether the OS saves the wider registers on a context switch
+	int regs[4];
+	__cpuid(regs, 0);
+	const int maxLeaf = regs[0];
+	__cpuid(regs, 1);
+	const bool sse2 = (regs[3] & (1 << 26)) != 0;
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	const bool avx = (regs[2] & (1 << 28)) != 0;
+	const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool avx2 = false;
+	bool avx512 = false;
+	if (maxLeaf >= 7) {
+		__cpuidex(regs, 7, 0);
+		avx2 = avx && (regs[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+		avx512 = (regs[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+	}
+	switch (isa) {
+	case SJCIsa::Scalar: return true;
+	case SJCIsa::SSE2: return sse2;
+	case SJCIsa::AVX2: return avx2;
+	case SJCIsa::AVX512: return avx512;
+	}
+	return false;
+#else
+	return isa == SJCIsa::Scalar;
+#endif
+}
+
+// The kernels for one instruction set, or nullptr if this CPU (or this build) cannot run them
+inline const SJCKernelTable* sjcKernelsFor(SJCIsa isa) noexcept
+{
+	static constexpr SJCKernelTable scalar = sjcMakeKernelTable<SJCScalarKernel>("scalar");
+#if SJC_X86
+	static constexpr SJCKernelTable sse2 = sjcMakeKernelTable<SJCSse2Kernel>("sse2");
+	static constexpr SJCKernelTable avx2 = sjcMakeKernelTable<SJCAvx2Kernel>("avx2");
+	static constexpr SJCKernelTable avx512 = sjcMakeKernelTable<SJCAvx512Kernel>("avx512");
+#endif
+	if (!sjcCpuSupports(isa)) return nullptr;
+	switch (isa) {
+#if SJC_X86
+	case SJCIsa::SSE2: return &sse2;
+	case SJCIsa::AVX2: return &avx2;
+	case SJCIsa::AVX512: return &avx512;
+#endif
+	default: return &scalar;
+	}
+}
+
+// The widest kernels this CPU supports, chosen once
+inline const SJCKernelTable& sjcKernels() noexcept
+{
+	static const SJCKernelTable& best = [] () -> const SJCKernelTable& {
+		for (SJCIsa isa : { SJCIsa::AVX512, SJCIsa::AVX2, SJCIsa::SSE2 }) {
+			if (const SJCKernelTable* table = sjcKernelsFor(isa)) return *table;
+		}
+		return *sjcKernelsFor(SJCIsa::Scalar);
+	}();
+	return best;
+}
+
+// EXPRESSION HOOK
+// =================
+// Maps an expression operation to its kernel
+
+template <typename Op>
+inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor = nullptr;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCPlus> = &SJCKernelTable::add;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCMinus> = &SJCKernelTable::sub;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCMultiplies> = &SJCKernelTable::mul;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCMin> = &SJCKernelTable::min;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCMax> = &SJCKernelTable::max;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCEqual> = &SJCKernelTable::equal;
+template <> inline constexpr SJCBinaryKernel SJCKernelTable::* sjcKernelFor<SJCGreater> = &SJCKernelTable::greater;
+
+// Evaluates expr into dst with a kernel and returns true, or returns false if no kernel fits
+template <typename T, typename Expr>
+bool sjcEvaluateWithKernel(T*, const Expr&, std::size_t) noexcept
+{
+	return false;
+}
+template <typename Op>
+bool sjcEvaluateWithKernel(int* dst, const SJCExprBinary<Op, SJCExprLeaf<int>, SJCExprLeaf<int>>& expr, std::size_t n) noexcept
+{
+	if constexpr (sjcKernelFor<Op> != nullptr) {
+		(sjcKernels().*sjcKernelFor<Op>)(expr.l.data, expr.r.data, dst, n);
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "SJCGrowthPolicy.h"
+#include "SJCVectorStats.h"
+
+#if defined(_WIN32)
+#error "SJCMappedVector.h needs POSIX mmap"
+#endif
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// FILE-BACKED VECTOR
+// ==================
+// BasicSJCMappedVector maps a file of raw T, with no header, into memory instead of reading it. Opening is an
+// open, an fstat and an mmap, whatever the size of the file, and the pages are read in by the OS as the items
+// are first touched, so a dataset bigger than RAM can be walked and is never held twice (page cache plus a
+// copy on the heap).
+// SJCMapMode::ReadOnly - PROT_READ. Writing an item faults, push_back throws std::logic_error.
+// SJCMapMode::Shared   - MAP_SHARED read-write, created if missing. Writes go to the file. push_back on a full
+//                        mapping extends the file with ftruncate (by GrowthPolicy, whole pages by default) and
+//                        remaps it; on Linux mremap keeps the pages already faulted in.
+// SJCMapMode::Private  - MAP_PRIVATE read-write. Writes are copy-on-write and never reach the file.
+//                        push_back on a full mapping copies the items into anonymous memory once; on Linux
+//                        later growth mremaps that memory, elsewhere it copies the items again.
+// size() is the number of items in the file when it is opened (its length over sizeof(T)). In Shared mode the
+// file holds the spare capacity too while the vector is open; the destructor truncates it back to size()
+// items. flush() msyncs the items to the file without closing it.
+// Items are the file's bytes, so T must be trivially copyable. Like the concurrent vector the object owns a
+// file descriptor and a mapping that cannot be duplicated: it is movable but not copyable.
+// Reads take part in SJCExpr arithmetic: SJCVector r(mapped + weights);
+// headerBytes skips a header at the start of the file, which the vector never touches (see SJCSerialize.h).
+//		BasicSJCMappedVector<int> v("data.bin", SJCMapMode::Shared);
+//		v.push_back(42);
+//		v.flush();
+enum class SJCMapMode {
+	ReadOnly,
+	Shared,
+	Private
+};
+
+template <typename T = int, typename TracePolicy = SilentTrace, typename GrowthPolicy = SJCPageGrowth<>>
+class BasicSJCMappedVector : private SJCTraced<BasicSJCMappedVector<T, TracePolicy, GrowthPolicy>, TracePolicy> {
+	static_assert(std::is_trivially_copyable_v<T>, "Items are read straight from the file's bytes");
+	using Traced = SJCTraced<BasicSJCMappedVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+
+	T* ptr_ = nullptr;
+	char* base_ = nullptr;			// Start of the mapping: the file's header when ptr_ maps the file
+	size_t size_{ 0 };				// Slots mapped
+	size_t header_{ 0 };			// File bytes before item 0
+	long long last_{ -1 };
+	int fd_{ -1 };
+	SJCMapMode mode_{ SJCMapMode::ReadOnly };
+	bool anonymous_{ false };		// Private mode: the items have moved from the file to memory of their own
+	std::string name_{ "unnamed" };
+
+public:
+	using value_type = T;
+	using sjc_vector_tag = void;	// Takes part in SJCExpr arithmetic
+
+	// Throws std::system_error if the file cannot be opened or mapped
+	explicit BasicSJCMappedVector(std::string path, SJCMapMode mode = SJCMapMode::ReadOnly, std::size_t headerBytes = 0)
+		: header_(headerBytes), mode_(mode), name_(std::move(path)) {
+		fd_ = mode == SJCMapMode::Shared ? ::open(name_.c_str(), O_RDWR | O_CREAT, 0644) : ::open(name_.c_str(), O_RDONLY);
+		if (fd_ < 0) fail("open");
+		struct stat st;
+		if (::fstat(fd_, &st) != 0) {
+			const int error = errno;
+			::close(fd_);
+			fail("fstat", error);
+		}
+		const size_t fileBytes = static_cast<size_t>(st.st_size);
+		const size_t count = fileBytes > header_ ? (fileBytes - header_) / sizeof(T) : 0;
+		if (count > 0) {
+			void* p = ::mmap(nullptr, header_ + count * sizeof(T), protection(), sharing(), fd_, 0);
+			if (p == MAP_FAILED) {
+				const int error = errno;
+				::close(fd_);
+				fail("mmap", error);
+			}
+			base_ = static_cast<char*>(p);
+			ptr_ = reinterpret_cast<T*>(base_ + header_);
+			size_ = count;
+		}
+		last_ = static_cast<long long>(count) - 1;
+		trace(SJCEvent::NamedCtor, "Mapped ctor on ", name_, " with ", count, " items\n");
+	}
+	~BasicSJCMappedVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		close();
+	}
+	BasicSJCMappedVector(const BasicSJCMappedVector&) = delete;
+	BasicSJCMappedVector& operator=(const BasicSJCMappedVector&) = delete;
+	BasicSJCMappedVector(BasicSJCMappedVector&& rhs) noexcept
+		: ptr_(std::exchange(rhs.ptr_, nullptr)), base_(std::exchange(rhs.base_, nullptr)), size_(std::exchange(rhs.size_, 0)),
+		header_(rhs.header_), last_(std::exchange(rhs.last_, -1)),
+		fd_(std::exchange(rhs.fd_, -1)), mode_(rhs.mode_), anonymous_(std::exchange(rhs.anonymous_, false)),
+		name_(std::move(rhs.name_)) {
+		trace(SJCEvent::MoveCtor, "Mapped move ctor from ", SJCName{ name_ }, '\n');
+	}
+	// The old file is closed (and truncated to its items) once the moved-from rhs is destroyed
+	BasicSJCMappedVector& operator=(BasicSJCMappedVector&& rhs) noexcept {
+		record(SJCEvent::MoveAssign);
+		BasicSJCMappedVector moved(std::move(rhs));
+		moved.swap(*this);
+		return *this;
+	}
+	void swap(BasicSJCMappedVector& rhs) noexcept {
+		record(SJCEvent::Swap);
+		using std::swap;
+		swap(ptr_, rhs.ptr_);
+		swap(base_, rhs.base_);
+		swap(size_, rhs.size_);
+		swap(header_, rhs.header_);
+		swap(last_, rhs.last_);
+		swap(fd_, rhs.fd_);
+		swap(mode_, rhs.mode_);
+		swap(anonymous_, rhs.anonymous_);
+		swap(name_, rhs.name_);
+	}
+	friend void swap(BasicSJCMappedVector& a, BasicSJCMappedVector& b) noexcept {
+		a.swap(b);
+	}
+
+	T& operator[](std::size_t i) noexcept { return ptr_[i]; }
+	const T& operator[](std::size_t i) const noexcept { return ptr_[i]; }
+	T* data() noexcept { return ptr_; }
+	const T* data() const noexcept { return ptr_; }
+	std::size_t size() const noexcept { return static_cast<std::size_t>(last_ + 1); }
+	std::size_t capacity() const noexcept { return size_; }
+	bool empty() const noexcept { return last_ < 0; }
+	SJCMapMode mode() const noexcept { return mode_; }
+	const std::string& name() const noexcept { return name_; }
+
+	void push_back(T newValue) {
+		record(SJCEvent::PushBack);
+		if (mode_ == SJCMapMode::ReadOnly) throw std::logic_error("push_back on a read-only mapping of " + name_);
+		if (size() == size_) grow(GrowthPolicy::grow(size_, sizeof(T)));
+		ptr_[++last_] = newValue;
+	}
+	// Writes the items back to the file and, with wait, returns once they are on disk (MS_SYNC rather than
+	// MS_ASYNC). Only Shared mappings write to the file, for the other modes this does nothing.
+	// msync needs a page-aligned address, so it starts at base_ (the header, if any) rather than at item 0.
+	void flush(bool wait = true) {
+		if (mode_ != SJCMapMode::Shared || empty()) return;
+		if (::msync(base_, header_ + size() * sizeof(T), wait ? MS_SYNC : MS_ASYNC) != 0) fail("msync");
+	}
+
+private:
+	int protection() const noexcept { return mode_ == SJCMapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE; }
+	int sharing() const noexcept { return mode_ == SJCMapMode::Private ? MAP_PRIVATE : MAP_SHARED; }
+	// Throws with errno of the call that failed
+	[[noreturn]] void fail(const char* call, int error = errno) const {
+		throw std::system_error(error, std::generic_category(), std::string(call) + " " + name_);
+	}
+	// Bytes from base_ to the end of the last slot
+	size_t mappedBytes() const noexcept { return static_cast<size_t>(reinterpret_cast<char*>(ptr_) - base_) + size_ * sizeof(T); }
+	// Leaves *this untouched if it throws
+	void grow(size_t newSize) {
+		void* p = MAP_FAILED;
+		size_t offset = header_;		// Bytes of the new mapping before item 0
+		bool remapped = false;			// mremap has already let go of the old mapping
+		if (mode_ == SJCMapMode::Shared) {
+			if (::ftruncate(fd_, static_cast<off_t>(header_ + newSize * sizeof(T))) != 0) fail("ftruncate");
+#if defined(__linux__)
+			if (ptr_ != nullptr) {
+				p = ::mremap(base_, mappedBytes(), header_ + newSize * sizeof(T), MREMAP_MAYMOVE);
+				remapped = true;
+			}
+			else
+#endif
+			p = ::mmap(nullptr, header_ + newSize * sizeof(T), protection(), sharing(), fd_, 0);
+			if (p == MAP_FAILED) {
+				const int error = errno;
+				(void)::ftruncate(fd_, static_cast<off_t>(header_ + size_ * sizeof(T)));
+				fail(remapped ? "mremap" : "mmap", error);
+			}
+		}
+		else {
+			// The file must not change, so the items move to memory of their own, once
+			offset = 0;
+#if defined(__linux__)
+			if (anonymous_) {
+				p = ::mremap(base_, mappedBytes(), newSize * sizeof(T), MREMAP_MAYMOVE);
+				if (p == MAP_FAILED) fail("mremap");
+				remapped = true;
+			}
+			else
+#endif
+			{
+				p = ::mmap(nullptr, newSize * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED) fail("mmap");
+				if (!empty()) std::memcpy(p, ptr_, size() * sizeof(T));
+				record(SJCEvent::CopyData, size() * sizeof(T));
+			}
+			anonymous_ = true;
+		}
+		if (ptr_ != nullptr && !remapped) ::munmap(base_, mappedBytes());
+		base_ = static_cast<char*>(p);
+		ptr_ = reinterpret_cast<T*>(base_ + offset);
+		size_ = newSize;
+		record(SJCEvent::Allocate, newSize * sizeof(T));
+	}
+	// Unmaps, gives the spare capacity back to the file and closes it
+	void close() noexcept {
+		if (ptr_ != nullptr) ::munmap(base_, mappedBytes());
+		if (fd_ >= 0) {
+			if (mode_ == SJCMapMode::Shared) (void)::ftruncate(fd_, static_cast<off_t>(header_ + size() * sizeof(T)));
+			::close(fd_);
+		}
+		ptr_ = nullptr;
+		base_ = nullptr;
+		fd_ = -1;
+	}
+};
+
+template <typename T>
+using SJCMappedVectorOf = BasicSJCMappedVector<T, SJCVECTOR_TRACE_POLICY>;
+using SJCMappedVector = SJCMappedVectorOf<int>;
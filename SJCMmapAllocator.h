@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SJC_HAS_MREMAP 1
+#else
+#define SJC_HAS_MREMAP 0
+#endif
+
+// MMAP ALLOCATOR
+// ==============
+// Buffers of at least ThresholdBytes are mapped directly from the OS with mmap, smaller ones come from
+// std::allocator as before. The allocator also provides reallocate(), which SJCBuffer uses to grow buffers
+// of trivial types: when both the old and the new buffer are mapped, mremap(MREMAP_MAYMOVE) moves the
+// pages into a bigger mapping instead of copying them, so growing a 1 GB vector costs page-table updates
+// rather than 1 GB of memory traffic.
+// mremap is Linux only. Elsewhere every buffer comes from std::allocator and reallocate() copies.
+//		BasicSJCVector<int, SJCMmapAllocator<int>> v;
+
+template <typename T, std::size_t ThresholdBytes = (std::size_t{ 4 } << 20)>
+struct SJCMmapAllocator {
+	using value_type = T;
+	template <typename U>
+	struct rebind { using other = SJCMmapAllocator<U, ThresholdBytes>; };
+
+	SJCMmapAllocator() = default;
+	template <typename U>
+	SJCMmapAllocator(const SJCMmapAllocator<U, ThresholdBytes>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+#if SJC_HAS_MREMAP
+		if (mapped(n)) {
+			void* p = ::mmap(nullptr, mappedBytes(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED) throw std::bad_alloc();
+			return static_cast<T*>(p);
+		}
+#endif
+		return std::allocator<T>().allocate(n);
+	}
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+#if SJC_HAS_MREMAP
+		if (mapped(n)) {
+			::munmap(p, mappedBytes(n));
+			return;
+		}
+#endif
+		std::allocator<T>().deallocate(p, n);
+	}
+	// Moves the items p[0, count) into a buffer of newN slots and frees p's oldN slots. Only for trivially
+	// copyable T. Remapping moves every page; copying copies only the count items, as SJCBuffer reports.
+	// Throws std::bad_alloc and leaves p untouched on failure.
+	T* reallocate(T* p, std::size_t oldN, std::size_t count, std::size_t newN)
+	{
+#if SJC_HAS_MREMAP
+		if (p != nullptr && remaps(oldN, newN)) {
+			void* q = ::mremap(p, mappedBytes(oldN), mappedBytes(newN), MREMAP_MAYMOVE);
+			if (q == MAP_FAILED) throw std::bad_alloc();
+			return static_cast<T*>(q);
+		}
+#endif
+		T* q = allocate(newN);
+		if (p != nullptr) {
+			if (count > 0) std::memcpy(static_cast<void*>(q), p, count * sizeof(T));
+			deallocate(p, oldN);
+		}
+		return q;
+	}
+	// True if reallocate(p, oldN, newN) remaps pages rather than copying them
+	static bool remaps(std::size_t oldN, std::size_t newN) noexcept
+	{
+		return SJC_HAS_MREMAP && mapped(oldN) && mapped(newN);
+	}
+
+	template <typename U>
+	bool operator==(const SJCMmapAllocator<U, ThresholdBytes>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const SJCMmapAllocator<U, ThresholdBytes>&) const noexcept { return false; }
+
+private:
+	static bool mapped(std::size_t n) noexcept { return n * sizeof(T) >= ThresholdBytes; }
+#if SJC_HAS_MREMAP
+	static std::size_t mappedBytes(std::size_t n) noexcept
+	{
+		static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+		return (n * sizeof(T) + page - 1) / page * page;
+	}
+#endif
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "SJCVector.h"
+
+// POLYMORPHIC MEMORY RESOURCES
+// ============================
+// SJCPmrVectorOf<T> allocates through a std::pmr::memory_resource chosen at run time, e.g. a monotonic arena
+// per request that is dropped in one go instead of freeing every vector:
+//		std::pmr::monotonic_buffer_resource arena;
+//		SJCPmrVectorOf<int> v(&arena);						// allocator from a memory_resource*
+//		SJCPmrVectorOf<int> w("w", 16, &arena);
+// polymorphic_allocator never propagates. Copies use the default resource, and assignment keeps each
+// vector's own resource, moving items between resources when they differ. Only vectors on the same resource
+// can be swapped (see ALLOCATOR PROPAGATION in SJCVector.h). Moves keep the resource of the vector moved from.
+// The resource must outlive every vector allocated from it.
+template <typename T, std::size_t InlineCapacity = 0>
+using SJCPmrVectorOf = BasicSJCVector<T, std::pmr::polymorphic_allocator<T>, SJCVECTOR_TRACE_POLICY,
+	SJCDoublingGrowth, InlineCapacity>;
+using SJCPmrVector = SJCPmrVectorOf<int>;
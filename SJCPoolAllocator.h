@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <utility>
+
+#include "SJCGrowthPolicy.h"
+
+// BUFFER POOL
+// ===========
+// SJCPoolAllocator<T> recycles buffers through a per-thread cache of free lists, one per size class
+// (the jemalloc classes of sjcSizeClass, see SJCGrowthPolicy.h). Freed buffers go on the free list of their
+// class instead of back to the heap, and the next request in the same class takes one off. Arithmetic that
+// builds and drops same-sized vectors over and over (SJCVector o(n + m) in a loop) stops allocating once
+// every size it uses has been freed once.
+// Each thread caches at most MaxCachedBytes. Buffers that would take it over the cap, or are bigger than the
+// cap themselves, go straight back to the heap. A buffer may be freed on a different thread from the one that
+// allocated it; it then joins that thread's cache. A thread's cache is freed when the thread exits.
+// SJCBufferPool<MaxCachedBytes>::stats() reports the calling thread's hits, misses and cached bytes.
+//		BasicSJCVector<int, SJCPoolAllocator<int>> v;
+
+struct SJCPoolStats {
+	std::size_t hits{ 0 };			// Requests served from the cache
+	std::size_t misses{ 0 };		// Requests that went to the heap
+	std::size_t evictions{ 0 };		// Freed buffers the cap sent back to the heap
+	std::size_t bytesCached{ 0 };	// Bytes sitting in the free lists now
+	double hitRate() const noexcept
+	{
+		const std::size_t requests = hits + misses;
+		return requests == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(requests);
+	}
+	friend std::ostream& operator<<(std::ostream& os, const SJCPoolStats& s)
+	{
+		return os << "hits:" << s.hits << " misses:" << s.misses << " hit rate:" << s.hitRate()
+			<< " evictions:" << s.evictions << " bytes cached:" << s.bytesCached;
+	}
+};
+
+// Position of sjcSizeClass(bytes) in the list of classes: 8, 16, 32, 48, 64, then four per doubling
+inline std::size_t sjcSizeClassIndex(std::size_t bytes) noexcept
+{
+	const std::size_t size = sjcSizeClass(bytes);
+	if (size <= 64) return size / 16;
+	const std::size_t lg = sjcFloorLog2(size - 1);
+	const std::size_t delta = std::size_t{ 1 } << (lg - 2);
+	return 5 + (lg - 6) * 4 + (size - (std::size_t{ 1 } << lg)) / delta - 1;
+}
+
+template <std::size_t MaxCachedBytes>
+class SJCBufferPool {
+	// A cached buffer holds the link to the next one, every class is at least 8 bytes
+	struct FreeBuffer {
+		FreeBuffer* next;
+	};
+	static constexpr std::size_t classes = 5 + (sizeof(std::size_t) * 8 - 6) * 4;
+
+	FreeBuffer* free_[classes]{};
+	SJCPoolStats stats_;
+	// Set when the calling thread's pool has been destroyed: buffers freed later, e.g. by a static vector
+	// destroyed after the thread's thread_local objects, go straight to the heap
+	static inline thread_local bool exited_ = false;
+
+	SJCBufferPool() = default;
+	~SJCBufferPool() {
+		exited_ = true;
+		for (std::size_t c = 0; c < classes; c++) {
+			while (free_[c] != nullptr) ::operator delete(std::exchange(free_[c], free_[c]->next));
+		}
+	}
+	static SJCBufferPool& local() {
+		thread_local SJCBufferPool pool;
+		return pool;
+	}
+public:
+	SJCBufferPool(const SJCBufferPool&) = delete;
+	SJCBufferPool& operator=(const SJCBufferPool&) = delete;
+
+	// The calling thread's numbers
+	static SJCPoolStats stats() { return exited_ ? SJCPoolStats{} : local().stats_; }
+
+	static void* allocate(std::size_t bytes) {
+		if (exited_) return ::operator new(bytes);
+		return local().take(bytes);
+	}
+	static void deallocate(void* p, std::size_t bytes) noexcept {
+		if (exited_) ::operator delete(p);
+		else local().give(p, bytes);
+	}
+
+private:
+	void* take(std::size_t bytes) {
+		const std::size_t size = sjcSizeClass(bytes);
+		if (size <= MaxCachedBytes) {
+			FreeBuffer*& head = free_[sjcSizeClassIndex(bytes)];
+			if (head != nullptr) {
+				stats_.hits++;
+				stats_.bytesCached -= size;
+				return std::exchange(head, head->next);
+			}
+		}
+		stats_.misses++;
+		// Cacheable buffers get their whole class, so any request in the class can reuse them
+		return ::operator new(size <= MaxCachedBytes ? size : bytes);
+	}
+	void give(void* p, std::size_t bytes) noexcept {
+		const std::size_t size = sjcSizeClass(bytes);
+		if (size > MaxCachedBytes || stats_.bytesCached + size > MaxCachedBytes) {
+			if (size <= MaxCachedBytes) stats_.evictions++;
+			::operator delete(p);
+			return;
+		}
+		FreeBuffer*& head = free_[sjcSizeClassIndex(bytes)];
+		head = ::new (p) FreeBuffer{ head };
+		stats_.bytesCached += size;
+	}
+};
+
+template <typename T, std::size_t MaxCachedBytes = (std::size_t{ 4 } << 20)>
+struct SJCPoolAllocator {
+	static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "SJCPoolAllocator only provides operator new alignment");
+	using value_type = T;
+	using Pool = SJCBufferPool<MaxCachedBytes>;
+	template <typename U>
+	struct rebind { using other = SJCPoolAllocator<U, MaxCachedBytes>; };
+
+	SJCPoolAllocator() = default;
+	template <typename U>
+	SJCPoolAllocator(const SJCPoolAllocator<U, MaxCachedBytes>&) noexcept {}
+
+	T* allocate(std::size_t n) { return static_cast<T*>(Pool::allocate(n * sizeof(T))); }
+	void deallocate(T* p, std::size_t n) noexcept { Pool::deallocate(p, n * sizeof(T)); }
+
+	template <typename U>
+	bool operator==(const SJCPoolAllocator<U, MaxCachedBytes>&) const noexcept { return true; }
+	template <typename U>
+	bool operator!=(const SJCPoolAllocator<U, MaxCachedBytes>&) const noexcept { return false; }
+};
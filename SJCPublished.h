@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// PUBLISHED SNAPSHOTS
+// ===================
+// SJCPublished<Vec> holds the current version of a read-mostly vector (any SJCVector type, or anything else
+// that is copyable or movable), read-copy-update style:
+// Readers take a ReadGuard and read the current version through it. Taking one is an atomic increment and
+// two loads, with no loop and no lock, so a reader never waits for a writer or for other readers.
+// Writers build the next version off to the side, with the copy constructor in update() or by moving a
+// finished vector into publish(), and publish it with one atomic pointer exchange. Readers that already hold
+// a guard keep the version they started with.
+// Reclamation is epoch based. Each reader counts itself in the counter for the current epoch's parity (odd or
+// even). The counters are sharded per thread, on their own cache lines, so readers do not share a counter line.
+// After publishing, the writer waits for the counters of the previous epoch parity to drain, moves to the next
+// epoch, and waits for the previous parity again before it deletes the old version. Waiting for both parities
+// also catches a reader that read the parity just before an earlier epoch change.
+// Writers are serialized by a mutex and may block, which is the right trade for a few updates a second.
+// A thread must not publish while it holds a ReadGuard on the same SJCPublished: it would wait for itself.
+//		SJCPublished<SJCVector> table(SJCVector("table"));
+//		{ auto v = table.read(); use((*v)[i]); }					// reader
+//		table.update([](SJCVector& next) { next.push_back(42); });	// writer
+template <typename Vec, std::size_t Shards = 16>
+class SJCPublished {
+	static_assert(Shards > 0, "SJCPublished needs at least one reader shard");
+	struct alignas(64) ReaderShard {
+		std::atomic<std::size_t> active[2]{};	// Readers inside, by epoch parity
+	};
+
+	std::atomic<const Vec*> current_;
+	std::atomic<std::size_t> epoch_{ 0 };
+	mutable ReaderShard readers_[Shards];
+	std::mutex writer_;
+
+public:
+	// Keeps the version it was taken on alive and readable until it is destroyed
+	class ReadGuard {
+		const Vec* vec_;
+		std::atomic<std::size_t>* counter_;
+		friend class SJCPublished;
+		ReadGuard(const Vec* vec, std::atomic<std::size_t>* counter) noexcept : vec_(vec), counter_(counter) {}
+	public:
+		ReadGuard(ReadGuard&& rhs) noexcept : vec_(rhs.vec_), counter_(std::exchange(rhs.counter_, nullptr)) {}
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+		ReadGuard& operator=(ReadGuard&&) = delete;
+		~ReadGuard() {
+			// Release: everything read through this guard happens before the writer deletes the version
+			if (counter_ != nullptr) counter_->fetch_sub(1, std::memory_order_release);
+		}
+		const Vec& operator*() const noexcept { return *vec_; }
+		const Vec* operator->() const noexcept { return vec_; }
+	};
+
+	explicit SJCPublished(Vec initial = Vec()) : current_(new Vec(std::move(initial))) {}
+	// No reader or writer may still be using the object
+	~SJCPublished() {
+		delete current_.load(std::memory_order_relaxed);
+	}
+	SJCPublished(const SJCPublished&) = delete;
+	SJCPublished& operator=(const SJCPublished&) = delete;
+
+	// Wait-free
+	ReadGuard read() const noexcept {
+		std::atomic<std::size_t>* counter = &readers_[shard()].active[epoch_.load() & 1];
+		// Sequentially consistent, like the writer's exchange and epoch change: if the writer's wait misses
+		// this increment, the load below is ordered after the exchange and sees the new version
+		counter->fetch_add(1);
+		return ReadGuard(current_.load(), counter);
+	}
+	// Calls f with the current version and returns its result by value: a reference into the version would
+	// dangle once the guard lets the writer reclaim it
+	template <typename F>
+	auto read(F&& f) const {
+		ReadGuard guard = read();
+		return std::forward<F>(f)(*guard);
+	}
+
+	// Makes next the current version. Returns once no reader can still see the version it replaced.
+	void publish(Vec next) {
+		std::unique_ptr<const Vec> fresh(new Vec(std::move(next)));
+		std::lock_guard<std::mutex> lock(writer_);
+		replace(std::move(fresh));
+	}
+	// Copies the current version, lets f change the copy, and publishes it
+	template <typename F>
+	void update(F&& f) {
+		std::lock_guard<std::mutex> lock(writer_);
+		std::unique_ptr<Vec> next(new Vec(*current_.load()));
+		std::forward<F>(f)(*next);
+		replace(std::move(next));
+	}
+
+private:
+	// Called with writer_ held
+	void replace(std::unique_ptr<const Vec> fresh) {
+		std::unique_ptr<const Vec> old(current_.exchange(fresh.release()));
+		const std::size_t epoch = epoch_.load();
+		waitForReaders((epoch + 1) & 1);	// Readers that picked the parity before the last epoch change
+		epoch_.store(epoch + 1);
+		waitForReaders(epoch & 1);
+	}
+	void waitForReaders(std::size_t parity) const noexcept {
+		for (auto& shard : readers_) {
+			while (shard.active[parity].load() != 0) std::this_thread::yield();
+		}
+	}
+	// Threads are spread over the shards in the order they first read
+	static std::size_t shard() noexcept {
+		static std::atomic<std::size_t> next{ 0 };
+		thread_local const std::size_t mine = next.fetch_add(1, std::memory_order_relaxed) % Shards;
+		return mine;
+	}
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "SJCBuffer.h"
+#include "SJCGrowthPolicy.h"
+#include "SJCVectorStats.h"
+
+// RING BUFFER
+// ===========
+// BasicSJCRingVector puts first_ to work: it is the slot that holds item 0, and the items run from there
+// around the end of the buffer and back to slot 0. push_back, push_front, pop_front and pop_back are all O(1),
+// so the vector works as a queue or deque without ever shifting items.
+// Growing (resize, or a push on a full buffer) linearizes the items into the new buffer, which for trivially
+// relocatable T is at most two memcpy calls (see SJCBuffer::growRing), and resets first_ to 0.
+// The items are not contiguous once they wrap, so there is no data() and no SJCExpr arithmetic.
+// Like BasicSJCVector every slot is a live object: popping moves the item out and leaves its slot behind.
+// Popping an empty ring is undefined, check empty() first.
+template <typename T = int, typename Allocator = std::allocator<T>, typename TracePolicy = SilentTrace,
+	typename GrowthPolicy = SJCDoublingGrowth>
+class BasicSJCRingVector : private SJCTraced<BasicSJCRingVector<T, Allocator, TracePolicy, GrowthPolicy>, TracePolicy> {
+	using Buffer = SJCBuffer<Allocator>;
+	using traits = std::allocator_traits<Allocator>;
+	using Traced = SJCTraced<BasicSJCRingVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+	static constexpr bool swapsAllocator = traits::propagate_on_container_swap::value;
+	static constexpr bool alwaysEqual = traits::is_always_equal::value;
+
+	T* ptr_ = nullptr;
+	size_t size_{ 0 };				// Slots in ptr_
+	size_t first_{ 0 };				// Slot holding item 0
+	long long last_{ -1 };			// Index of the last item, counted from first_
+	std::string name_{ "unnamed" };
+	Allocator alloc_{};
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+
+	BasicSJCRingVector() {
+		trace(SJCEvent::DefaultCtor, "Ring ctor\n");
+	}
+	BasicSJCRingVector(std::string name, const Allocator& alloc = Allocator()) : name_(std::move(name)), alloc_(alloc) {
+		trace(SJCEvent::NamedCtor, "Ring ctor with name ", name_, '\n');
+	}
+	~BasicSJCRingVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		Buffer::release(alloc_, ptr_, size_);
+	}
+	// The copy keeps the capacity but starts its items at slot 0
+	BasicSJCRingVector(const BasicSJCRingVector& rhs)
+		: alloc_(traits::select_on_container_copy_construction(rhs.alloc_)) {
+		trace(SJCEvent::CopyCtor, "Ring copy ctor from ", SJCName{ rhs.name_ }, '\n');
+		if (rhs.size_ == 0) return;
+		const size_t count = rhs.size();
+		const size_t head = rhs.headCount();
+		T* p = traits::allocate(alloc_, rhs.size_);
+		try {
+			Buffer::copyInto(alloc_, rhs.ptr_ + rhs.first_, head, p, head);
+			try {
+				Buffer::copyInto(alloc_, rhs.ptr_, count - head, p + head, rhs.size_ - head);
+			}
+			catch (...) {
+				Buffer::destroy(alloc_, p, head);
+				throw;
+			}
+		}
+		catch (...) {
+			traits::deallocate(alloc_, p, rhs.size_);
+			throw;
+		}
+		ptr_ = p;
+		size_ = rhs.size_;
+		last_ = rhs.last_;
+		record(SJCEvent::Allocate, size_ * sizeof(T));
+		record(SJCEvent::CopyData, count * sizeof(T));
+	}
+	BasicSJCRingVector(BasicSJCRingVector&& rhs) noexcept : alloc_(std::move(rhs.alloc_)) {
+		trace(SJCEvent::MoveCtor, "Ring move ctor. Stole guts of rvalue: ", SJCName{ rhs.name_ }, '\n');
+		ptr_ = std::exchange(rhs.ptr_, nullptr);
+		size_ = std::exchange(rhs.size_, 0);
+		first_ = std::exchange(rhs.first_, 0);
+		last_ = std::exchange(rhs.last_, -1);
+	}
+	// A copy in memory from another allocator that does not propagate on swap has its items moved over instead
+	BasicSJCRingVector& operator=(BasicSJCRingVector copy) noexcept(swapsAllocator || alwaysEqual) {
+		trace(SJCEvent::ByValueAssign, "Ring by-value assignment (=) operator\n");
+		if constexpr (!swapsAllocator && !alwaysEqual) {
+			if (!(alloc_ == copy.alloc_)) {
+				const size_t count = copy.size();
+				resize(count);
+				for (size_t i = 0; i < count; i++) ptr_[i] = std::move(copy[i]);
+				last_ = static_cast<long long>(count) - 1;
+				return *this;
+			}
+		}
+		copy.swap(*this);
+		return *this;
+	}
+	// The allocators are swapped only if they propagate on swap, otherwise they must be equal (as for std::vector)
+	void swap(BasicSJCRingVector& rhs) noexcept {
+		record(SJCEvent::Swap);
+		assert(swapsAllocator || alloc_ == rhs.alloc_);
+		using std::swap;
+		swap(ptr_, rhs.ptr_);
+		swap(size_, rhs.size_);
+		swap(first_, rhs.first_);
+		swap(last_, rhs.last_);
+		if constexpr (swapsAllocator) swap(alloc_, rhs.alloc_);
+	}
+	friend void swap(BasicSJCRingVector& a, BasicSJCRingVector& b) noexcept {
+		a.swap(b);
+	}
+
+	// Index i counts from the front, wherever the front currently is
+	T& operator[](std::size_t i) noexcept { return ptr_[slot(i)]; }
+	const T& operator[](std::size_t i) const noexcept { return ptr_[slot(i)]; }
+	T& front() noexcept { return ptr_[first_]; }
+	const T& front() const noexcept { return ptr_[first_]; }
+	T& back() noexcept { return ptr_[slot(size() - 1)]; }
+	const T& back() const noexcept { return ptr_[slot(size() - 1)]; }
+	std::size_t size() const noexcept { return static_cast<std::size_t>(last_ + 1); }
+	std::size_t capacity() const noexcept { return size_; }
+	bool empty() const noexcept { return last_ < 0; }
+	allocator_type get_allocator() const { return alloc_; }
+	const std::string& name() const noexcept { return name_; }
+
+	void push_back(T newValue) {
+		record(SJCEvent::PushBack);
+		if (size() == size_) grow();
+		ptr_[slot(size())] = std::move(newValue);
+		last_++;
+	}
+	void push_front(T newValue) {
+		record(SJCEvent::PushFront);
+		if (size() == size_) grow();
+		first_ = (first_ == 0 ? size_ : first_) - 1;
+		ptr_[first_] = std::move(newValue);
+		last_++;
+	}
+	T pop_front() {
+		record(SJCEvent::Pop);
+		T item = std::move(ptr_[first_]);
+		first_ = slot(1);
+		last_--;
+		return item;
+	}
+	T pop_back() {
+		record(SJCEvent::Pop);
+		T item = std::move(ptr_[slot(size() - 1)]);
+		last_--;
+		return item;
+	}
+	void rename(std::string newName) {
+		record(SJCEvent::Rename);
+		trace(SJCName{ name_ }, "renamed to ");
+		name_ = std::move(newName);
+		trace(SJCName{ name_ }, '\n');
+	}
+	// Linearizes the items into a buffer of newSize slots. Items beyond newSize are dropped from the back.
+	void resize(size_t newSize, SJCFill fill = SJCFill::ForOverwrite) {
+		if (newSize == 0) newSize = 1;
+		const size_t keep = std::min(size(), newSize);
+		ptr_ = Buffer::growRing(alloc_, ptr_, size_, first_, keep, newSize, fill);
+		record(SJCEvent::Allocate, newSize * sizeof(T));
+		record(SJCEvent::CopyData, keep * sizeof(T));
+		size_ = newSize;
+		first_ = 0;
+		last_ = static_cast<long long>(keep) - 1;
+		trace(SJCEvent::Resize, "Ring resize of ", SJCName{ name_ }, "to ", size_, " with ", last_ + 1, " items\n");
+	}
+
+private:
+	// Slot of item i. first_ + i never reaches 2 * size_, so one compare replaces the modulo.
+	size_t slot(size_t i) const noexcept {
+		const size_t s = first_ + i;
+		return s >= size_ ? s - size_ : s;
+	}
+	// Items stored from first_ up to the end of the buffer, before the ring wraps
+	size_t headCount() const noexcept {
+		return std::min(size(), size_ - first_);
+	}
+	void grow() {
+		resize(GrowthPolicy::grow(size_, sizeof(T)));
+	}
+};
+
+template <typename T>
+using SJCRingVectorOf = BasicSJCRingVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY>;
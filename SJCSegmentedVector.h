@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SJCGrowthPolicy.h"
+#include "SJCVectorStats.h"
+
+// SEGMENTED STORAGE
+// =================
+// BasicSJCVector moves every item when it grows, which costs O(n) and invalidates every pointer to an item.
+// BasicSJCSegmentedVector never moves an item: it grows by allocating one more chunk and adding it to a
+// small directory of chunk pointers. Only the directory (one pointer per chunk) is ever copied.
+// Pointers and references to items stay valid until the item is popped or the vector is destroyed.
+// The Layout policy decides how big chunk k is and maps an index to (chunk, offset) without a loop:
+// SJCFixedChunks<Shift>     - every chunk holds 2^Shift items: chunk = i >> Shift, offset = i & (2^Shift - 1).
+// SJCGeometricChunks<Shift> - chunk k holds 2^(Shift + k) items, so a few dozen chunks cover any size:
+//                             with j = i + 2^Shift, chunk = log2(j) - Shift and offset = j with its top bit masked off.
+// Like BasicSJCIncrementalVector only the items are live objects, chunks start as raw memory.
+// The items are not contiguous, so there is no data() and no SJCExpr arithmetic.
+
+template <std::size_t Shift = 10>
+struct SJCFixedChunks {
+	static constexpr std::size_t chunkSize(std::size_t) noexcept { return std::size_t{ 1 } << Shift; }
+	static std::size_t chunkOf(std::size_t i) noexcept { return i >> Shift; }
+	static std::size_t offsetOf(std::size_t i) noexcept { return i & ((std::size_t{ 1 } << Shift) - 1); }
+};
+
+template <std::size_t Shift = 4>
+struct SJCGeometricChunks {
+	static constexpr std::size_t chunkSize(std::size_t k) noexcept { return std::size_t{ 1 } << (Shift + k); }
+	static std::size_t chunkOf(std::size_t i) noexcept { return sjcFloorLog2(i + chunkSize(0)) - Shift; }
+	static std::size_t offsetOf(std::size_t i) noexcept
+	{
+		const std::size_t j = i + chunkSize(0);
+		return j ^ (std::size_t{ 1 } << sjcFloorLog2(j));
+	}
+};
+
+template <typename T = int, typename Allocator = std::allocator<T>, typename TracePolicy = SilentTrace,
+	typename Layout = SJCFixedChunks<>>
+class BasicSJCSegmentedVector : private SJCTraced<BasicSJCSegmentedVector<T, Allocator, TracePolicy, Layout>, TracePolicy> {
+	using traits = std::allocator_traits<Allocator>;
+	using Traced = SJCTraced<BasicSJCSegmentedVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+	static constexpr bool swapsAllocator = traits::propagate_on_container_swap::value;
+	static constexpr bool alwaysEqual = traits::is_always_equal::value;
+	using Directory = std::vector<T*, typename traits::template rebind_alloc<T*>>;
+
+	Directory chunks_;				// chunks_[k] holds Layout::chunkSize(k) slots
+	size_t size_{ 0 };				// Slots in all chunks
+	long long last_{ -1 };			// Index of the last item
+	std::string name_{ "unnamed" };
+	Allocator alloc_{};
+
+public:
+	using value_type = T;
+	using allocator_type = Allocator;
+
+	BasicSJCSegmentedVector() {
+		trace(SJCEvent::DefaultCtor, "Segmented ctor\n");
+	}
+	BasicSJCSegmentedVector(std::string name, const Allocator& alloc = Allocator())
+		: chunks_(alloc), name_(std::move(name)), alloc_(alloc) {
+		trace(SJCEvent::NamedCtor, "Segmented ctor with name ", name_, '\n');
+	}
+	~BasicSJCSegmentedVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		clear();
+	}
+	// The copy gets as many chunks as its items need, filled chunk by chunk
+	BasicSJCSegmentedVector(const BasicSJCSegmentedVector& rhs)
+		: alloc_(traits::select_on_container_copy_construction(rhs.alloc_)) {
+		trace(SJCEvent::CopyCtor, "Segmented copy ctor from ", SJCName{ rhs.name_ }, '\n');
+		const size_t count = rhs.size();
+		try {
+			for (size_t k = 0; size() < count; k++) {
+				addChunk();
+				const size_t n = std::min(count - size(), Layout::chunkSize(k));
+				if constexpr (std::is_trivially_copyable_v<T>) {
+					std::memcpy(static_cast<void*>(chunks_[k]), rhs.chunks_[k], n * sizeof(T));
+					last_ += static_cast<long long>(n);
+				}
+				else {
+					for (size_t i = 0; i < n; i++, last_++) traits::construct(alloc_, chunks_[k] + i, rhs.chunks_[k][i]);
+				}
+			}
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+		record(SJCEvent::CopyData, count * sizeof(T));
+	}
+	BasicSJCSegmentedVector(BasicSJCSegmentedVector&& rhs) noexcept
+		: chunks_(std::move(rhs.chunks_)), alloc_(std::move(rhs.alloc_)) {
+		trace(SJCEvent::MoveCtor, "Segmented move ctor. Stole guts of rvalue: ", SJCName{ rhs.name_ }, '\n');
+		rhs.chunks_.clear();
+		size_ = std::exchange(rhs.size_, 0);
+		last_ = std::exchange(rhs.last_, -1);
+	}
+	// A copy in memory from another allocator that does not propagate on swap has its items moved over instead
+	BasicSJCSegmentedVector& operator=(BasicSJCSegmentedVector copy) noexcept(swapsAllocator || alwaysEqual) {
+		trace(SJCEvent::ByValueAssign, "Segmented by-value assignment (=) operator\n");
+		if constexpr (!swapsAllocator && !alwaysEqual) {
+			if (!(alloc_ == copy.alloc_)) {
+				clear();
+				for (size_t i = 0; i < copy.size(); i++) push_back(std::move(copy[i]));
+				return *this;
+			}
+		}
+		copy.swap(*this);
+		return *this;
+	}
+	// The allocators (and the directory's) are swapped only if they propagate on swap, otherwise they must be
+	// equal (as for std::vector)
+	void swap(BasicSJCSegmentedVector& rhs) noexcept {
+		record(SJCEvent::Swap);
+		assert(swapsAllocator || alloc_ == rhs.alloc_);
+		using std::swap;
+		swap(chunks_, rhs.chunks_);
+		swap(size_, rhs.size_);
+		swap(last_, rhs.last_);
+		if constexpr (swapsAllocator) swap(alloc_, rhs.alloc_);
+	}
+	friend void swap(BasicSJCSegmentedVector& a, BasicSJCSegmentedVector& b) noexcept {
+		a.swap(b);
+	}
+
+	T& operator[](std::size_t i) noexcept { return chunks_[Layout::chunkOf(i)][Layout::offsetOf(i)]; }
+	const T& operator[](std::size_t i) const noexcept { return chunks_[Layout::chunkOf(i)][Layout::offsetOf(i)]; }
+	std::size_t size() const noexcept { return static_cast<std::size_t>(last_ + 1); }
+	std::size_t capacity() const noexcept { return size_; }
+	std::size_t chunkCount() const noexcept { return chunks_.size(); }
+	bool empty() const noexcept { return last_ < 0; }
+	allocator_type get_allocator() const { return alloc_; }
+	const std::string& name() const noexcept { return name_; }
+
+	void push_back(T newValue) {
+		record(SJCEvent::PushBack);
+		if (size() == size_) addChunk();
+		traits::construct(alloc_, &(*this)[size()], std::move(newValue));
+		last_++;
+	}
+	// The emptied slot stays in its chunk, chunks are only freed by clear() and the destructor
+	T pop_back() {
+		record(SJCEvent::Pop);
+		T& slot = (*this)[size() - 1];
+		T item = std::move(slot);
+		traits::destroy(alloc_, &slot);
+		last_--;
+		return item;
+	}
+	void rename(std::string newName) {
+		record(SJCEvent::Rename);
+		trace(SJCName{ name_ }, "renamed to ");
+		name_ = std::move(newName);
+		trace(SJCName{ name_ }, '\n');
+	}
+	// Destroys the items and frees every chunk
+	void clear() noexcept {
+		for (size_t i = 0; i < size(); i++) traits::destroy(alloc_, &(*this)[i]);
+		for (size_t k = 0; k < chunks_.size(); k++) traits::deallocate(alloc_, chunks_[k], Layout::chunkSize(k));
+		chunks_.clear();
+		size_ = 0;
+		last_ = -1;
+	}
+
+private:
+	// Growth allocates the next chunk and never touches the items already stored
+	void addChunk() {
+		const size_t k = chunks_.size();
+		const size_t n = Layout::chunkSize(k);
+		// The directory entry comes first, so a failure there cannot leak the chunk
+		chunks_.push_back(nullptr);
+		try {
+			chunks_.back() = traits::allocate(alloc_, n);
+		}
+		catch (...) {
+			chunks_.pop_back();
+			throw;
+		}
+		size_ += n;
+		record(SJCEvent::Allocate, n * sizeof(T));
+		trace(SJCEvent::Resize, "Segmented ", SJCName{ name_ }, "added chunk ", k, " of ", n, " slots\n");
+	}
+};
+
+template <typename T, typename Layout = SJCFixedChunks<>>
+using SJCSegmentedVectorOf = BasicSJCSegmentedVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY, Layout>;
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "SJCMappedVector.h"
+#include "SJCVector.h"
+
+#if defined(_WIN32)
+#error "SJCSerialize.h needs POSIX open, pread, writev and mmap"
+#endif
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// BINARY FORMAT
+// =============
+// An SJCVector file is a 64-byte header followed by the items' raw bytes:
+//		offset  0  magic          "SJCVEC\r\n" (the \r\n catches files mangled by text-mode transfers)
+//		offset  8  version        sjcFormatVersion
+//		offset 12  byte order     0x01020304 as written by the saving machine
+//		offset 16  element type   SJCElementType
+//		offset 20  element size   sizeof(T)
+//		offset 24  count          number of items
+//		offset 32  payload offset 64, so the payload is cache-line aligned in the file and in a mapping of it
+//		offset 40  checksum       sjcChecksum of the payload
+//		offset 48  reserved       zero
+// Every field is in the saving machine's byte order. A file saved on a machine of the other byte order is
+// rejected rather than converted, so loading never parses the items one by one.
+// sjcSave writes the header and the payload with one writev.
+// sjcLoad allocates the vector once and reads the payload straight into its buffer with one read.
+// sjcMap maps the file instead (see SJCMappedVector.h), so the payload becomes the vector's items with no copy
+// at all. It checks only the header by default, so opening stays O(1); pass SJCVerify::Checksum to check the
+// payload too, which reads all of it.
+// Files that are not SJCVector files, or hold another element type, throw SJCFormatError. Failed system
+// calls throw std::system_error.
+// POSIX only, like SJCMappedVector.h: the Windows builds of this project cannot include it.
+//		sjcSave(v, "v.sjc");
+//		SJCVector w = sjcLoad<SJCVector>("v.sjc");
+//		SJCMappedVector m = sjcMap<SJCMappedVector>("v.sjc");
+
+constexpr std::uint32_t sjcFormatVersion = 1;
+
+enum class SJCElementType : std::uint32_t {
+	Int8 = 1, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float32, Float64
+};
+
+template <typename T>
+constexpr SJCElementType sjcElementType() noexcept
+{
+	static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "SJCVector files hold integers or floating point");
+	if constexpr (std::is_floating_point_v<T>) {
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only float and double are supported");
+		return sizeof(T) == 4 ? SJCElementType::Float32 : SJCElementType::Float64;
+	}
+	else {
+		// Int8, Int16, Int32 and Int64 are 1, 3, 5 and 7, the unsigned codes follow each of them
+		constexpr std::uint32_t lg = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+		return static_cast<SJCElementType>(1 + 2 * lg + (std::is_signed_v<T> ? 0 : 1));
+	}
+}
+
+struct SJCFileHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint32_t elementType;
+	std::uint32_t elementSize;
+	std::uint64_t count;
+	std::uint64_t payloadOffset;
+	std::uint64_t checksum;
+	std::uint8_t reserved[16];
+};
+static_assert(sizeof(SJCFileHeader) == 64, "The header is 64 bytes on every platform");
+
+struct SJCFormatError : std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+enum class SJCVerify {
+	HeaderOnly,
+	Checksum		// Also checks the payload against the header's checksum
+};
+
+// Four multiply-xor lanes over 8-byte words, so the loop is not one long dependency chain and keeps up with
+// memory bandwidth. Catches corruption, not tampering.
+inline std::uint64_t sjcChecksum(const void* data, std::size_t bytes) noexcept
+{
+	constexpr std::uint64_t prime = 0x100000001b3ull;
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	std::uint64_t lane[4] = { 0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9e3779b97f4a7c15ull, bytes };
+	std::size_t i = 0;
+	for (; i + 32 <= bytes; i += 32) {
+		for (std::size_t l = 0; l < 4; l++) {
+			std::uint64_t w;
+			std::memcpy(&w, p + i + 8 * l, 8);
+			lane[l] = (lane[l] ^ w) * prime;
+		}
+	}
+	std::uint64_t h = lane[0] ^ (lane[1] >> 1) ^ (lane[2] << 1) ^ (lane[3] >> 3);
+	for (; i < bytes; i++) h = (h ^ p[i]) * prime;
+	return h ^ (h >> 29);
+}
+
+struct SJCSerializer {
+	static constexpr char magic[8] = { 'S', 'J', 'C', 'V', 'E', 'C', '\r', '\n' };
+	static constexpr std::uint32_t byteOrder = 0x01020304;
+
+	template <typename T>
+	static SJCFileHeader makeHeader(const T* items, std::size_t count) noexcept
+	{
+		SJCFileHeader h{};
+		std::memcpy(h.magic, magic, sizeof magic);
+		h.version = sjcFormatVersion;
+		h.byteOrder = byteOrder;
+		h.elementType = static_cast<std::uint32_t>(sjcElementType<T>());
+		h.elementSize = sizeof(T);
+		h.count = count;
+		h.payloadOffset = sizeof(SJCFileHeader);
+		h.checksum = sjcChecksum(items, count * sizeof(T));
+		return h;
+	}
+
+	template <typename Vec>
+	static void save(const Vec& v, const std::string& path)
+	{
+		using T = typename Vec::value_type;
+		const SJCFileHeader h = makeHeader(v.data(), v.size());
+		const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) fail("open", path);
+		const std::size_t total = sizeof h + v.size() * sizeof(T);
+		std::size_t done = 0;
+		while (done < total) {
+			// One writev normally writes everything, further calls only follow a partial write
+			iovec iov[2];
+			int parts = 0;
+			if (done < sizeof h) iov[parts++] = { const_cast<char*>(reinterpret_cast<const char*>(&h)) + done, sizeof h - done };
+			const std::size_t payloadDone = done < sizeof h ? 0 : done - sizeof h;
+			if (v.size() > 0) iov[parts++] = { const_cast<char*>(reinterpret_cast<const char*>(v.data())) + payloadDone, v.size() * sizeof(T) - payloadDone };
+			const ssize_t n = ::writev(fd, iov, parts);
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				const int error = errno;
+				::close(fd);
+				fail("writev", path, error);
+			}
+			done += static_cast<std::size_t>(n);
+		}
+		if (::close(fd) != 0) fail("close", path);
+	}
+
+	// Opens the file and checks its header is an SJCVector file of T. Returns the file descriptor.
+	template <typename T>
+	static int openChecked(const std::string& path, SJCFileHeader& h)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) fail("open", path);
+		try {
+			struct stat st;
+			if (::fstat(fd, &st) != 0) fail("fstat", path);
+			if (readAt(fd, &h, sizeof h, 0, path) != sizeof h || std::memcmp(h.magic, magic, sizeof magic) != 0)
+				throw SJCFormatError(path + ": not an SJCVector file");
+			if (h.version != sjcFormatVersion)
+				throw SJCFormatError(path + ": format version " + std::to_string(h.version) + " is not supported");
+			if (h.byteOrder != byteOrder) throw SJCFormatError(path + ": saved with the other byte order");
+			if (h.elementType != static_cast<std::uint32_t>(sjcElementType<T>()) || h.elementSize != sizeof(T))
+				throw SJCFormatError(path + ": holds another element type");
+			const std::uint64_t fileBytes = static_cast<std::uint64_t>(st.st_size);
+			if (h.payloadOffset < sizeof h || h.payloadOffset % alignof(T) != 0 || h.payloadOffset > fileBytes
+				|| h.count != (fileBytes - h.payloadOffset) / sizeof(T) || (fileBytes - h.payloadOffset) % sizeof(T) != 0)
+				throw SJCFormatError(path + ": size does not match its header");
+		}
+		catch (...) {
+			::close(fd);
+			throw;
+		}
+		return fd;
+	}
+
+	template <typename Vec>
+	static Vec load(const std::string& path, SJCVerify verify)
+	{
+		using T = typename Vec::value_type;
+		SJCFileHeader h;
+		const int fd = openChecked<T>(path, h);
+		try {
+			const std::size_t count = static_cast<std::size_t>(h.count);
+			Vec v(count);
+			const std::size_t bytes = count * sizeof(T);
+			if (readAt(fd, v.data(), bytes, h.payloadOffset, path) != bytes) throw SJCFormatError(path + ": payload is truncated");
+			if (verify == SJCVerify::Checksum) checkPayload(v.data(), count, h, path);
+			v.size_ = count;
+			::close(fd);
+			return v;
+		}
+		catch (...) {
+			::close(fd);
+			throw;
+		}
+	}
+
+	template <typename Mapped>
+	static Mapped map(const std::string& path, SJCMapMode mode, SJCVerify verify)
+	{
+		using T = typename Mapped::value_type;
+		// Writes through a shared mapping would leave the checksum stale
+		if (mode == SJCMapMode::Shared) throw std::logic_error("sjcMap: " + path + " can only be mapped ReadOnly or Private");
+		SJCFileHeader h;
+		::close(openChecked<T>(path, h));
+		Mapped m(path, mode, static_cast<std::size_t>(h.payloadOffset));
+		if (m.size() != h.count) throw SJCFormatError(path + ": changed while it was opened");
+		if (verify == SJCVerify::Checksum) checkPayload(m.data(), m.size(), h, path);
+		return m;
+	}
+
+private:
+	template <typename T>
+	static void checkPayload(const T* items, std::size_t count, const SJCFileHeader& h, const std::string& path)
+	{
+		if (sjcChecksum(items, count * sizeof(T)) != h.checksum) throw SJCFormatError(path + ": checksum mismatch");
+	}
+	// Reads until bytes have arrived or the file ends. Returns the bytes read.
+	static std::size_t readAt(int fd, void* dst, std::size_t bytes, std::uint64_t offset, const std::string& path)
+	{
+		std::size_t done = 0;
+		while (done < bytes) {
+			const ssize_t n = ::pread(fd, static_cast<char*>(dst) + done, bytes - done, static_cast<off_t>(offset + done));
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				fail("pread", path);
+			}
+			if (n == 0) break;
+			done += static_cast<std::size_t>(n);
+		}
+		return done;
+	}
+	[[noreturn]] static void fail(const char* call, const std::string& path, int error = errno)
+	{
+		throw std::system_error(error, std::generic_category(), std::string(call) + " " + path);
+	}
+};
+
+// Any vector with data() and size(): BasicSJCVector, BasicSJCMappedVector...
+template <typename Vec>
+void sjcSave(const Vec& v, const std::string& path)
+{
+	SJCSerializer::save(v, path);
+}
+// Vec is a BasicSJCVector
+template <typename Vec = SJCVector>
+Vec sjcLoad(const std::string& path, SJCVerify verify = SJCVerify::Checksum)
+{
+	return SJCSerializer::load<Vec>(path, verify);
+}
+// Mapped is a BasicSJCMappedVector. mode is ReadOnly or Private.
+template <typename Mapped = SJCMappedVector>
+Mapped sjcMap(const std::string& path, SJCMapMode mode = SJCMapMode::ReadOnly, SJCVerify verify = SJCVerify::HeaderOnly)
+{
+	return SJCSerializer::map<Mapped>(path, mode, verify);
+}
@@ -1,7 +1,36 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "SJCAssignPolicy.h"
+#include "SJCBuffer.h"
+#include "SJCDeleter.h"
+#include "SJCExpr.h"
+#include "SJCKernels.h"
+#include "SJCGrowthPolicy.h"
+#include "SJCVectorStats.h"
+
+// Keeps a rarely taken path (growing the buffer) out of line, so the common path around it inlines into callers
+#if defined(__GNUC__) || defined(__clang__)
+#define SJC_COLD __attribute__((noinline, cold))
+#define SJC_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#elif defined(_MSC_VER)
+#define SJC_COLD __declspec(noinline)
+#define SJC_UNLIKELY(x) (x)
+#else
+#define SJC_COLD
+#define SJC_UNLIKELY(x) (x)
+#endif
 
 // References
 // =========
@@ -94,30 +123,117 @@
 // Copy Assignment Operator - frees the left-hand resource and copies the right-hand one.
 // Move Assignment Operator - frees the left-hand resource and transfers ownership of the right-hand one.
 
+// TRACE POLICY
+// =============
+// All console output from the special member functions goes through TracePolicy (see SJCVectorTrace.h).
+// BasicSJCVector<T, Allocator, SilentTrace> compiles the logging out entirely. SJCVector uses SJCVECTOR_TRACE_POLICY,
+// which defaults to SilentTrace; define it as StreamTrace before including this header for the teaching output.
+
+// BY_VAL_OPERATOR picks the default assignment policy (see SJCAssignPolicy.h). Define SJCVECTOR_SPLIT_ASSIGNMENT
+// to default to the split copy/move assignment operators instead. Any vector type can name its own policy.
+#ifndef SJCVECTOR_SPLIT_ASSIGNMENT
 #define BY_VAL_OPERATOR
+#endif
+#ifdef BY_VAL_OPERATOR
+using SJCDefaultAssign = SJCByValueAssign;
+#else
+using SJCDefaultAssign = SJCSplitAssign;
+#endif
 
-class SJCVector {
-	std::unique_ptr<int[]> ptr_ = nullptr;		//Class manages resource
-	size_t size_{ 0 };
-	size_t first_;
-	long long last_;
+struct SJCSerializer;
+
+// ELEMENT TYPE AND ALLOCATOR
+// ============================
+// BasicSJCVector is a class template over the element type and allocator, so int, int64, float and double
+// buffers share one implementation. Copies and growth go through SJCBuffer (see SJCBuffer.h), which uses memcpy
+// for trivially copyable/relocatable T and element-wise std::move_if_noexcept otherwise.
+// std::unique_ptr<T[]> cannot free through an allocator, so the buffer is a raw pointer and the destructor
+// releases it. The move constructor is unchanged: it still just exchanges the pointer.
+// With an allocator that can reallocate (e.g. SJCMmapAllocator) resize grows trivial T without copying.
+// adopt() and release() hand a buffer in and out without copying it. An adopted buffer is freed by its
+// SJCDeleter rather than the allocator (see SJCDeleter.h).
+// GrowthPolicy picks the new capacity when push_back finds the buffer full (see SJCGrowthPolicy.h).
+
+// SMALL BUFFER
+// ==============
+// With InlineCapacity N > 0 the object holds N slots of its own and only spills to the heap when more are needed,
+// so default construction, the first N push_backs and copies of small vectors never allocate.
+// Inline items live inside the object, so they cannot be stolen: moving or swapping a vector that is still
+// inline moves its (at most N) items one by one. A moved-from vector falls back to its empty inline slots.
+// Shrinking with resize() to N or fewer slots gives the heap buffer back.
+// With N == 0 (the default) an empty vector has no buffer at all until the first push_back.
+
+// ALLOCATOR PROPAGATION
+// =======================
+// Stateful allocators (e.g. std::pmr::polymorphic_allocator, see SJCPmrVector.h) follow the standard container rules:
+// Copy constructor - the copy gets select_on_container_copy_construction(rhs allocator).
+// Move constructor - the allocator moves with the buffer.
+// Copy assignment  - the allocator is copied to *this only if propagate_on_container_copy_assignment says so.
+//                    The items are copied into memory from whichever allocator *this ends up with.
+// Move assignment  - the allocator moves to *this only if propagate_on_container_move_assignment says so. Then, or
+//                    if the allocators are equal, the buffer is stolen. Otherwise the items are moved into memory
+//                    from *this's own allocator, which can throw, so only then is move assignment not noexcept.
+//                    The by-value assignment operator follows the same rules for its parameter.
+// Swap             - the allocators are swapped only if propagate_on_container_swap says so. Otherwise they must be
+//                    equal, as for the standard containers (checked by an assert).
+// With std::allocator, or any allocator whose instances always compare equal, all of this is still a pointer swap.
+template <typename T = int, typename Allocator = std::allocator<T>, typename TracePolicy = SilentTrace,
+	typename GrowthPolicy = SJCDoublingGrowth, std::size_t InlineCapacity = 0, typename AssignPolicy = SJCDefaultAssign>
+class BasicSJCVector : private SJCInlineStorage<T, InlineCapacity>,
+	private SJCTraced<BasicSJCVector<T, Allocator, TracePolicy, GrowthPolicy, InlineCapacity, AssignPolicy>, TracePolicy> {
+	static_assert(InlineCapacity == 0
+		|| (std::is_nothrow_default_constructible_v<T> && std::is_nothrow_move_constructible_v<T>),
+		"Inline items are moved and refilled by the noexcept move constructor and swap");
+	using Buffer = SJCBuffer<Allocator>;
+	using traits = std::allocator_traits<Allocator>;
+	using Traced = SJCTraced<BasicSJCVector, TracePolicy>;
+	friend Traced;
+	using Traced::record;
+	using Traced::trace;
+	static constexpr bool alwaysEqual = traits::is_always_equal::value;
+	static constexpr bool assignsAllocator = traits::propagate_on_container_move_assignment::value;
+	static constexpr bool swapsAllocator = traits::propagate_on_container_swap::value;
+	static constexpr bool copiesAllocator = traits::propagate_on_container_copy_assignment::value;
+	// Parameter types of the assignment operators. The ones AssignPolicy does not use cannot be called.
+	using ByValueArg = std::conditional_t<AssignPolicy::byValue, BasicSJCVector, SJCUnusedAssign<0>>;
+	using CopyArg = std::conditional_t<AssignPolicy::byValue, SJCUnusedAssign<1>, const BasicSJCVector&>;
+	using MoveArg = std::conditional_t<AssignPolicy::byValue, SJCUnusedAssign<2>, BasicSJCVector&&>;
+
+	T* ptr_ = nullptr;		//Class manages resource
+	size_t capacity_{ 0 };	// Slots in ptr_, every one a live T
+	size_t size_{ 0 };		// Items, in slots [0, size_)
 	std::string name_{ "unnamed" };
+	Allocator alloc_{};
+	SJCDeleter<T> deleter_{};		// Frees an adopted buffer. Empty when the buffer is alloc_'s.
+	friend struct SJCSerializer;	// Loads files straight into the buffer (see SJCSerialize.h)
 
 public:
+	using value_type = T;
+	using allocator_type = Allocator;
+	using sjc_vector_tag = void;	// Takes part in SJCExpr arithmetic
+
 	// CONSTRUCTOR
 	// =============
 	// Rules of three, four and a half, five and zero DO NOT apply to constructors.
 	// The rules only apply to functions implicit in managing resources.
-	SJCVector() : SJCVector(1) {
-		std::cout << "Standard ctor\n";
+	// The constructors do not delegate to each other, so each construction is traced exactly once.
+	// Allocates nothing
+	BasicSJCVector() {
+		initSJCVector(0);
+		trace(SJCEvent::DefaultCtor, "Standard ctor\n");
+	}
+	explicit BasicSJCVector(const Allocator& alloc) : alloc_(alloc) {
+		initSJCVector(0);
+		trace(SJCEvent::DefaultCtor, "Standard ctor\n");
 	}
-	SJCVector(std::size_t size) {
+	BasicSJCVector(std::size_t size, const Allocator& alloc = Allocator()) : alloc_(alloc) {
 		initSJCVector(size);
-		std::cout << "Standard ctor with size\n";
+		trace(SJCEvent::SizedCtor, "Standard ctor with size\n");
 	}
-	SJCVector(std::string name, size_t size = 1) : SJCVector(size) {
-		name_ = name;
-		std::cout << "Standard ctor with name " << name_ << std::endl;
+	BasicSJCVector(std::string name, size_t size = 1, const Allocator& alloc = Allocator()) : alloc_(alloc) {
+		initSJCVector(size);
+		name_ = std::move(name);
+		trace(SJCEvent::NamedCtor, "Standard ctor with name ", name_, '\n');
 	}
 
 	// DESTRUCTOR
@@ -126,9 +242,9 @@ public:
 	// Put all cleanup code in the destructor. This makes the class EXCEPTION SAFE.
 	// There is only ever one destructor for a class.
 
-	~SJCVector() {
-		printName();
-		std::cout << "dtor\n";
+	~BasicSJCVector() {
+		trace(SJCEvent::Dtor, SJCName{ name_ }, "dtor\n");
+		releaseBuffer();
 	}
 	// COPY CONSTRUCTOR
 	// ===================
@@ -140,17 +256,29 @@ public:
 	// the default copy constructor (which copies just the pointer/Handle etc, but does not create a new resource
 	// fpr the copy). When both source and copy objects are eventually destroyed, their destructors each free the 
 	// same memory - DOUBLE FREE == BAD.
-	SJCVector(const SJCVector& rhs) {
-		std::cout << "Copy ctor. Copying data from ";
-		rhs.printName(); std::cout << "to "; printNameLn();
-		// Make sure to delete any existing resource before creating a new one
-		// ptr_ = new int[rhs.last_ + 1];
-		initSJCVector(rhs.size_);
-		// Copying the resource avoids double frees
-		const auto& srcBegin = rhs.ptr_.get();
-		std::copy(srcBegin, std::next(srcBegin, size_), ptr_.get());
-		last_ = rhs.last_;
+	BasicSJCVector(const BasicSJCVector& rhs)
+		: BasicSJCVector(rhs, traits::select_on_container_copy_construction(rhs.alloc_)) {}
+	// Copies into memory from alloc rather than from rhs's allocator (copy assignment uses it)
+	BasicSJCVector(const BasicSJCVector& rhs, const Allocator& alloc) : alloc_(alloc) {
+		trace("Copy ctor. Copying data from ", SJCName{ rhs.name_ }, "to ", SJCName{ name_ }, '\n');
+		// Named before the copy's events are recorded, so CountingTrace files them under "copy", not "unnamed"
 		rename("copy");
+		record(SJCEvent::CopyCtor);
+		// Copying the resource avoids double frees
+		// Only the items are copied, and the copy is sized for them rather than for rhs's capacity: items that
+		// fit in the inline slots stay there even if rhs has spilled to the heap
+		if (rhs.size() <= InlineCapacity) {
+			ptr_ = this->inlineData();
+			capacity_ = InlineCapacity;
+			if constexpr (InlineCapacity > 0) Buffer::copyInto(alloc_, rhs.ptr_, rhs.size(), ptr_, capacity_);
+		}
+		else {
+			ptr_ = Buffer::makeCopy(alloc_, rhs.ptr_, rhs.size(), rhs.size());
+			capacity_ = rhs.size();
+			record(SJCEvent::Allocate, capacity_ * sizeof(T));
+		}
+		record(SJCEvent::CopyData, rhs.size() * sizeof(T));
+		size_ = rhs.size_;
 	}
 	// MOVE CONSTRUCTOR
 	// ===================
@@ -158,13 +286,15 @@ public:
 	// Move constructor transfers ownership of the resource from rhs to this
 	// Fast because rhs wont be missed, just steal rhs's guts.
 
-	SJCVector(SJCVector&& rhs) noexcept {
-		std::cout << "Move ctor. Stole guts of rvalue: "; rhs.printNameLn();
-		ptr_ = std::exchange(rhs.ptr_, nullptr);	//ptr_ gets rhs.ptr_, rhs.ptr_ gets nullptr.
-		size_ = std::exchange(rhs.size_, 0);
-		last_ = std::exchange(rhs.last_, -1);
+	BasicSJCVector(BasicSJCVector&& rhs) noexcept : alloc_(std::move(rhs.alloc_)) {
+		trace(SJCEvent::MoveCtor, "Move ctor. Stole guts of rvalue: ", SJCName{ rhs.name_ }, '\n');
+		takeBuffer(rhs);
 	}
-#ifdef BY_VAL_OPERATOR
+	// ASSIGNMENT POLICY
+	// ===================
+	// AssignPolicy (see SJCAssignPolicy.h) chooses between the by-value assignment operator and the copy and move
+	// assignment operators below. The others take a parameter type nothing converts to, so they drop out.
+
 	// BY-VALUE ASSIGNMENT OPERATOR
 	// ==============================
 	// The copy & move assignment operators are similar. 
@@ -173,43 +303,91 @@ public:
 	// This approach transfers move semantics responsibility to the caller.
 	// It also ensures the moved or copied item is passed on the stack i.e. not great for large objects
 
-	SJCVector& operator=(SJCVector copy) noexcept {
-		std::cout << "By-value assignment (=) operator\n";
+	BasicSJCVector& operator=(ByValueArg copy) noexcept(assignsAllocator || alwaysEqual) {
+		trace(SJCEvent::ByValueAssign, "By-value assignment (=) operator\n");
+		if constexpr (!alwaysEqual) {
+			// A buffer from a different allocator cannot be swapped in: copy is treated as a move assignment source
+			if (!(alloc_ == copy.alloc_)) {
+				if constexpr (assignsAllocator) {
+					releaseBuffer();
+					alloc_ = std::move(copy.alloc_);
+					takeBuffer(copy);
+				}
+				else takeItems(copy);
+				return *this;
+			}
+		}
 		copy.swap(*this);
 		return *this;
 	}
-#else
 	// COPY ASSIGNMENT OPERATOR
 	// ===========================
 	// Free the left hand resource and copy the right hand one
 	// Use the copy and swap idiom. 
 	// This decouples any aliasing relationship between *this and rhs
-	SJCVector& operator=(const SJCVector& rhs) {
-		std::cout << "Copy assignment operator. (Uses Copy constructor)\n";
-		SJCVector copy = rhs;	//make a copy of the rhs object using the copy constructor
+	// With SJCReuseAssign the items are copied into the buffer *this already has when they fit, so there is
+	// no resource to free and none to acquire.
+	BasicSJCVector& operator=(CopyArg rhs) {
+		if constexpr (AssignPolicy::reusesCapacity) {
+			if (reuses(rhs)) {
+				trace(SJCEvent::CopyAssign, "Copy assignment operator. Copying into the existing buffer\n");
+				copyItems(rhs);
+				return *this;
+			}
+		}
+		trace(SJCEvent::CopyAssign, "Copy assignment operator. (Uses Copy constructor)\n");
+		//make a copy of the rhs object using the copy constructor, in memory from the allocator *this ends up with
+		BasicSJCVector copy(rhs, copiesAllocator ? rhs.alloc_ : alloc_);
 		copy.rename("copy");
+		if constexpr (copiesAllocator && !alwaysEqual) {
+			// rhs's allocator comes with the copy, ours frees our buffer first
+			if (!(alloc_ == copy.alloc_)) {
+				releaseBuffer();
+				alloc_ = copy.alloc_;
+				takeBuffer(copy);
+				trace("End of Copy assignment operator\n");
+				return *this;
+			}
+		}
 		copy.swap(*this);
-		std::cout << "End of Copy assignment operator\n";
+		trace("End of Copy assignment operator\n");
 		return *this;
 	}
 	// MOVE ASSIGNMENT OPERATOR
 	// ===========================
 	// Free the left-hand resource and transfer ownership of the rhs one
 
-	SJCVector& operator=(SJCVector&& rhs) noexcept {
-		std::cout << "Move assignment operator. Uses Move constructor\n";
-		SJCVector copy(std::move(rhs));	//make a copy of the rhs object using the MOVE constructor
-		copy.swap(*this);
-		std::cout << "End of Move assignment operator\n";
+	// Only a buffer from an allocator *this can free is stolen, otherwise the items are moved one by one
+	BasicSJCVector& operator=(MoveArg rhs) noexcept(assignsAllocator || alwaysEqual) {
+		trace(SJCEvent::MoveAssign, "Move assignment operator. Steals the rhs buffer\n");
+		if (this != &rhs) {
+			if constexpr (assignsAllocator) {
+				releaseBuffer();
+				alloc_ = std::move(rhs.alloc_);
+				takeBuffer(rhs);
+			}
+			else if (alwaysEqual || alloc_ == rhs.alloc_) {
+				releaseBuffer();
+				takeBuffer(rhs);
+			}
+			else takeItems(rhs);
+		}
+		trace("End of Move assignment operator\n");
 		return *this;
 	}
-#endif
-	void swap(SJCVector& rhs) noexcept {
+	// Unequal allocators that do not propagate on swap are undefined behaviour, as for the standard containers
+	void swap(BasicSJCVector& rhs) noexcept {
+		record(SJCEvent::Swap);
+		assert(swapsAllocator || alloc_ == rhs.alloc_);
 		using std::swap;
-		swap(ptr_, rhs.ptr_);
+		if (isInline() || rhs.isInline()) swapInline(rhs);
+		else {
+			swap(ptr_, rhs.ptr_);
+			swap(capacity_, rhs.capacity_);
+			swap(deleter_, rhs.deleter_);
+		}
 		swap(size_, rhs.size_);
-		swap(first_, rhs.first_);
-		swap(last_, rhs.last_);
+		if constexpr (swapsAllocator) swap(alloc_, rhs.alloc_);
 	}
 	// TWO ARGUMENT SWAP
 	// ====================
@@ -217,122 +395,524 @@ public:
 	// This is a non member function using the hidden friend idiom.
 	// The friend function is in the body of our class i.e. in its namespace
 	// Marking as friend lets the compiler know it is not a member
-	friend void swap(SJCVector& a, SJCVector& b) noexcept {
+	friend void swap(BasicSJCVector& a, BasicSJCVector& b) noexcept {
 		//Just calls the member swap
 		a.swap(b);
 	}
-	SJCVector operator+(const SJCVector& rhs) {
-		// Only works for types where '+" is defined
-		// This routine applies element by element addition
-		std::cout << "Addition operator overload for SJCVector\n";
-		if ((rhs.size_ == 0)
-			|| (size_ == 0)
-			|| (rhs.last_ != last_))
-		{
-			std::cout << "Cannot add vectors of zero size or unequal size\n";
-			return SJCVector();
-		}
-		std::cout << "Create local return vector\n";
-		SJCVector retVec(*this);
-		retVec.rename("retVec");
-		std::cout << "Added: ";
-		for (int i = 0; (i <= last_); i++)
-		{
-			retVec.ptr_[i] += rhs.ptr_[i];
-			if (i > 0) std::cout << ", ";
-			std::cout << retVec.ptr_[i];
-		}
-		std::cout << std::endl;
-		return retVec;
+	// ARITHMETIC
+	// ============
+	// a + b, a - b, a * b and scalar broadcasts build expression templates (see SJCExpr.h).
+	// Constructing or assigning from the expression evaluates every element in a single pass.
+	// When an operand is a temporary vector the result is computed in place in its buffer instead.
+	// Only works for types where the operators are defined.
+	template <typename Expr, typename = std::enable_if_t<SJCIsExpr<Expr>::value>>
+	BasicSJCVector(const Expr& expr, const Allocator& alloc = Allocator()) : alloc_(alloc) {
+		const size_t count = expr.size();
+		initSJCVector(count);
+		evaluate(ptr_, expr, count);
+		size_ = count;
+		trace(SJCEvent::ExprCtor, "Ctor from expression. ");
+		traceEvaluated();
+	}
+	// Reuses the buffer when it is big enough, otherwise allocates once
+	template <typename Expr, typename = std::enable_if_t<SJCIsExpr<Expr>::value>>
+	BasicSJCVector& operator=(const Expr& expr) {
+		assignExpr(expr);
+		trace(SJCEvent::ExprAssign, "Assignment from expression. ");
+		traceEvaluated();
+		return *this;
+	}
+	// In-place arithmetic with a vector, an expression or a scalar. Never allocates. Unlike an expression, whose
+	// result is empty when the sizes differ, an operand of another size throws std::length_error and leaves
+	// the vector as it was.
+	template <typename X, typename = std::enable_if_t<sjcIsExprOperand<X> || std::is_arithmetic_v<X>>>
+	BasicSJCVector& operator+=(const X& rhs) {
+		checkOperand(rhs, "+=");
+		assignExpr(sjcMakeExpr<SJCPlus>(*this, rhs));
+		trace(SJCEvent::Add, "In-place += on ", SJCName{ name_ }, '\n');
+		return *this;
+	}
+	template <typename X, typename = std::enable_if_t<sjcIsExprOperand<X> || std::is_arithmetic_v<X>>>
+	BasicSJCVector& operator-=(const X& rhs) {
+		checkOperand(rhs, "-=");
+		assignExpr(sjcMakeExpr<SJCMinus>(*this, rhs));
+		trace(SJCEvent::Subtract, "In-place -= on ", SJCName{ name_ }, '\n');
+		return *this;
 	}
+	template <typename X, typename = std::enable_if_t<sjcIsExprOperand<X> || std::is_arithmetic_v<X>>>
+	BasicSJCVector& operator*=(const X& rhs) {
+		checkOperand(rhs, "*=");
+		assignExpr(sjcMakeExpr<SJCMultiplies>(*this, rhs));
+		trace(SJCEvent::Multiply, "In-place *= on ", SJCName{ name_ }, '\n');
+		return *this;
+	}
+	// ELEMENT ACCESS
+	// ================
+	// size() is the number of items, capacity() the number of slots. Every slot holds a live T, items or not.
+	T& operator[](std::size_t i) noexcept { return ptr_[i]; }
+	const T& operator[](std::size_t i) const noexcept { return ptr_[i]; }
+	T* data() noexcept { return ptr_; }
+	const T* data() const noexcept { return ptr_; }
+	std::size_t size() const noexcept { return size_; }
+	std::size_t capacity() const noexcept { return capacity_; }
+	bool empty() const noexcept { return size_ == 0; }
+	allocator_type get_allocator() const { return alloc_; }
+	const std::string& name() const noexcept { return name_; }
 	void print() const 
 	{
 		printName();
 		printSize();
 		printItemsLn();
 	}
-	void push_back(int newValue) 
+	// APPEND
+	// ======
+	// The common case is one compare and one store, small enough to inline into the caller's loop. Growing
+	// lives in emplaceGrow, which is never inlined. An empty vector has capacity 0, so it takes that path too.
+	void push_back(T newValue) 
 	{
-		if ((size_ == last_ + 1) || size_ == 0) {
-			std::cout << "On push_back: ";
-			resize(size_ * 2 + 1);
-		}
-		if (size_ > last_ + 1) {
-			last_++;
-			ptr_[last_] = newValue;
-		}
-		else 
-			std::cout << "push_back fail due to full\n";
+		record(SJCEvent::PushBack);
+		if (SJC_UNLIKELY(size_ == capacity_)) emplaceGrow(std::move(newValue));
+		else ptr_[size_++] = std::move(newValue);
+	}
+	// Builds the item from args. Every slot already holds a live T, so the new item is moved into its slot.
+	template <typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		record(SJCEvent::PushBack);
+		if (SJC_UNLIKELY(size_ == capacity_)) return emplaceGrow(std::forward<Args>(args)...);
+		T newValue(std::forward<Args>(args)...);
+		ptr_[size_] = std::move(newValue);
+		return ptr_[size_++];
 	}
 	void rename(std::string newName) 
 	{
-		printName();
-		std::cout << "renamed to ";
-		name_ = newName;
-		printNameLn();
+		record(SJCEvent::Rename);
+		trace(SJCName{ name_ }, "renamed to ");
+		name_ = std::move(newName);
+		trace(SJCName{ name_ }, '\n');
 	}
-	void resize(size_t newSize)
+	// resize() sets the capacity: the buffer gets exactly newSize slots (at least 1) and keeps the items that fit.
+	// New slots are left uninitialized for trivial T (see SJCBuffer.h).
+	// Use resize(n, SJCFill::Zero) when the new slots must be zeroed.
+	void resize(size_t newSize, SJCFill fill = SJCFill::ForOverwrite)
 	{
 		if (newSize == 0) newSize = 1;
-		//TODO exception safety. Did the memory allocate?
-		if (auto newptr = std::make_unique<int[]>(newSize)) {
-			if (last_ >= 0) {
-				//Data to copy
-				//New size_ may be smaller than current data
-				if (newSize <= last_) last_ = newSize - 1;
-				//new size should not be 0
-				const auto& srcBegin = ptr_.get();
-				if (newSize > 0) std::copy(srcBegin, std::next(srcBegin, size_), newptr.get());
-				//old: if (newSize > 0) std::copy(ptr_, ptr_[0 + last_ + 1], newptr);
+		reallocate(newSize, fill);
+		trace(SJCEvent::Resize, "Resized ", SJCName{ name_ }, "to ", capacity_, " with ", size_, " items\n");
+	}
+	// CAPACITY AND BULK OPERATIONS
+	// ==============================
+	// Each of these allocates at most once, however many items it adds, and copies contiguous items of
+	// trivially copyable T with one memcpy.
+	// Makes room for at least n items. Never shrinks.
+	void reserve(size_t n)
+	{
+		if (n <= capacity_) return;
+		reallocate(n, SJCFill::ForOverwrite);
+		trace(SJCEvent::Resize, "Reserved ", SJCName{ name_ }, "to ", capacity_, " with ", size_, " items\n");
+	}
+	// Gives the free slots back. An empty vector gives its buffer back, keeping only its inline slots.
+	void shrink_to_fit()
+	{
+		if (capacity_ == std::max(size_, InlineCapacity)) return;
+		if (size_ == 0) {
+			releaseBuffer();
+			useInline();
+		}
+		else reallocate(size_, SJCFill::ForOverwrite);
+		trace(SJCEvent::Resize, "Shrunk ", SJCName{ name_ }, "to ", capacity_, " with ", size_, " items\n");
+	}
+	// Appends copies of [first, last). Pointers to T get the memcpy path and may point into this vector's own
+	// items. Single-pass input iterators cannot be counted up front, so they push_back one item at a time.
+	template <typename It>
+	void append(It first, It last)
+	{
+		using Category = typename std::iterator_traits<It>::iterator_category;
+		if constexpr (std::is_convertible_v<It, const T*>) {
+			appendItems(first, static_cast<size_t>(last - first));
+		}
+		else if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+			const size_t count = static_cast<size_t>(std::distance(first, last));
+			makeRoom(count);
+			std::copy(first, last, ptr_ + size_);	// The slots are live, so the items are copy assigned
+			record(SJCEvent::CopyData, count * sizeof(T));
+			size_ += count;
+		}
+		else {
+			for (; first != last; ++first) push_back(*first);
+		}
+	}
+	// rhs may be *this
+	void append(const BasicSJCVector& rhs)
+	{
+		appendItems(rhs.ptr_, rhs.size_);
+	}
+	// Replaces the items with n copies of value
+	void assign(size_t n, const T& value)
+	{
+		if (n > capacity_) {
+			const T fillValue(value);	// value may be one of the items about to be freed
+			T* p = Buffer::make(alloc_, n);
+			record(SJCEvent::Allocate, n * sizeof(T));
+			releaseBuffer();
+			ptr_ = p;
+			capacity_ = n;
+			std::fill_n(ptr_, n, fillValue);
+		}
+		else std::fill_n(ptr_, n, value);
+		size_ = n;
+	}
+	// ADOPT AND RELEASE
+	// ===================
+	// adopt() takes over a buffer of capacity slots, the first count of them items, without copying it. The
+	// vector destroys the slots and calls deleter when it lets go of the buffer: when it is destroyed, when a
+	// bigger buffer (from the allocator) replaces it, or when another buffer is assigned or adopted. Every slot
+	// must hold a live T (for trivial T any bytes will do) and the buffer must be writable.
+	// release() is the reverse: it hands out the buffer, with the deleter that frees it, and leaves the vector
+	// empty. A buffer from the allocator goes out with SJCDeleter::allocator(alloc), which frees it through a
+	// copy of the allocator: for a pmr vector the memory resource must outlive the buffer. Inline items live
+	// inside the object, so they are moved to a heap buffer first.
+	//		v.adopt(decoded, n, n, SJCDeleter<int>::free());
+	//		w.adopt(v.release());		// w now owns the decoder's buffer
+	void adopt(T* buffer, size_t count, size_t capacity, SJCDeleter<T> deleter) noexcept
+	{
+		releaseBuffer();
+		if (buffer == nullptr) useInline();
+		else {
+			ptr_ = buffer;
+			capacity_ = capacity;
+			deleter_ = deleter;
+		}
+		size_ = buffer == nullptr ? 0 : count;
+		trace(SJCEvent::Adopt, SJCName{ name_ }, "adopted ", capacity_, " slots with ", size_, " items\n");
+	}
+	void adopt(SJCReleasedBuffer<T> buffer) noexcept
+	{
+		adopt(buffer.data, buffer.size, buffer.capacity, buffer.deleter);
+	}
+	SJCReleasedBuffer<T> release()
+	{
+		SJCReleasedBuffer<T> out;
+		if (isInline()) {
+			if (size_ > 0) {
+				out.data = Buffer::relocate(alloc_, ptr_, capacity_, size_, size_);
+				out.capacity = size_;
+				record(SJCEvent::Allocate, size_ * sizeof(T));
+				record(SJCEvent::CopyData, size_ * sizeof(T));
+				useInline();
 			}
-			ptr_ = std::move(newptr);
-			size_ = newSize;
-			std::cout << "Resized "; printName(); std::cout << "to " << size_ << " with " << last_ + 1 << " items\n";
 		}
 		else {
-			std::cout << "\nError: resize failed\n";
-			return;
+			out.data = std::exchange(ptr_, nullptr);
+			out.capacity = std::exchange(capacity_, 0);
+			if (deleter_) out.deleter = std::exchange(deleter_, {});
+			if constexpr (InlineCapacity > 0) useInline();
 		}
+		if (out.data != nullptr && !out.deleter) out.deleter = SJCDeleter<T>::allocator(alloc_);
+		out.size = std::exchange(size_, 0);
+		trace(SJCEvent::Release, SJCName{ name_ }, "released ", out.capacity, " slots with ", out.size, " items\n");
+		return out;
 	}
 private:
-	void initSJCVector(size_t initialSize = 1)
+	// Evaluates expr into this vector. Reading and writing the same index is safe, so expr may refer to *this.
+	template <typename Expr>
+	void assignExpr(const Expr& expr)
+	{
+		const size_t count = expr.size();
+		if (count > capacity_) {
+			T* newptr = Buffer::make(alloc_, count);
+			record(SJCEvent::Allocate, count * sizeof(T));
+			evaluate(newptr, expr, count);
+			releaseBuffer();
+			ptr_ = newptr;
+			capacity_ = count;
+		}
+		else {
+			evaluate(ptr_, expr, count);
+		}
+		size_ = count;
+	}
+	// Scalars fit any vector, vectors and expressions must have as many items as this one
+	template <typename X>
+	void checkOperand(const X& rhs, const char* op) const
+	{
+		if constexpr (!std::is_arithmetic_v<X>) {
+			if (rhs.size() != size_) {
+				throw std::length_error(name_ + " " + op + ": " + std::to_string(size_) + " items and "
+					+ std::to_string(rhs.size()) + " items");
+			}
+		}
+	}
+	template <typename Expr>
+	static void evaluate(T* dst, const Expr& expr, size_t count)
+	{
+		// A single operation on two int vectors runs on the SIMD kernels (see SJCKernels.h)
+		if (sjcEvaluateWithKernel(dst, expr, count)) return;
+		for (size_t i = 0; i < count; i++) dst[i] = static_cast<T>(expr[i]);
+	}
+	void traceEvaluated() const
+	{
+		if constexpr (TracePolicy::streaming) {
+			if (empty()) trace("Empty result (empty or unequal size operands)\n");
+			else {
+				trace("Evaluated: ");
+				printItems(TracePolicy::out(), false);
+				trace('\n');
+			}
+		}
+	}
+	// Moves the items into a buffer of newSize slots, keeping those that fit. newSize > 0.
+	void reallocate(size_t newSize, SJCFill fill)
+	{
+		//New capacity_ may be smaller than current data
+		const size_t keep = std::min(size(), newSize);
+		if (InlineCapacity > 0 && newSize <= InlineCapacity) {
+			// Fits in the inline slots, a heap buffer is given back
+			if (isInline()) {
+				if (fill == SJCFill::Zero) std::fill(ptr_ + keep, ptr_ + capacity_, T());
+			}
+			else {
+				Buffer::moveInto(alloc_, ptr_, capacity_, keep, this->inlineData(), InlineCapacity, fill);
+				deallocate(ptr_, capacity_);
+				ptr_ = this->inlineData();
+				record(SJCEvent::CopyData, keep * sizeof(T));
+			}
+			newSize = InlineCapacity;
+		}
+		else if (isInline() || deleter_) {
+			// Spills to the heap, or leaves an adopted buffer for one from the allocator.
+			// The inline slots are left as raw memory, an adopted buffer goes back to its deleter.
+			T* old = ptr_;
+			ptr_ = Buffer::relocate(alloc_, ptr_, capacity_, keep, newSize, fill);
+			if (deleter_) deallocate(old, capacity_);
+			record(SJCEvent::Allocate, newSize * sizeof(T));
+			record(SJCEvent::CopyData, keep * sizeof(T));
+		}
+		else {
+			// Buffer::grow throws (leaving *this untouched) if the memory did not allocate
+			ptr_ = Buffer::grow(alloc_, ptr_, capacity_, keep, newSize, fill);
+			record(SJCEvent::Allocate, newSize * sizeof(T));
+			record(SJCEvent::CopyData, Buffer::growCopyBytes(capacity_, keep, newSize));
+		}
+		capacity_ = newSize;
+		size_ = keep;
+	}
+	// The item is built before growing: args may refer to an item in the buffer that growing frees
+	template <typename... Args>
+	SJC_COLD T& emplaceGrow(Args&&... args)
 	{
-		size_ = initialSize;
-		ptr_ = std::make_unique<int[]>(size_);
-		first_ = 0;
-		last_ = -1;
+		T newValue(std::forward<Args>(args)...);
+		trace("On push_back: ");
+		resize(GrowthPolicy::grow(capacity_, sizeof(T)));
+		ptr_[size_] = std::move(newValue);
+		return ptr_[size_++];
+	}
+	// Grows, geometrically, so that count more items fit
+	void makeRoom(size_t count)
+	{
+		if (size_ + count > capacity_) reallocate(std::max(size_ + count, GrowthPolicy::grow(capacity_, sizeof(T))), SJCFill::ForOverwrite);
+	}
+	// Appends count items copied from src, which may point into this vector's own items
+	void appendItems(const T* src, size_t count)
+	{
+		if (count == 0) return;
+		if (size_ + count > capacity_) {
+			// Growing moves the items, so a source among them moves too
+			const bool own = !std::less<const T*>()(src, ptr_) && std::less<const T*>()(src, ptr_ + capacity_);
+			const size_t offset = own ? static_cast<size_t>(src - ptr_) : 0;
+			makeRoom(count);
+			if (own) src = ptr_ + offset;
+		}
+		if constexpr (std::is_trivially_copyable_v<T>) std::memcpy(static_cast<void*>(ptr_ + size_), src, count * sizeof(T));
+		else std::copy(src, src + count, ptr_ + size_);
+		record(SJCEvent::CopyData, count * sizeof(T));
+		size_ += count;
+	}
+	// Sizes that fit in the inline slots (none when InlineCapacity is 0) do not allocate
+	void initSJCVector(size_t initialSize)
+	{
+		if (initialSize <= InlineCapacity) useInline();
+		else {
+			capacity_ = initialSize;
+			ptr_ = Buffer::make(alloc_, capacity_);
+			record(SJCEvent::Allocate, capacity_ * sizeof(T));
+		}
+		size_ = 0;
+	}
+	// SMALL BUFFER HELPERS
+	// ======================
+	// The inline slots are live objects only while ptr_ points at them.
+	bool isInline() const noexcept
+	{
+		return InlineCapacity > 0 && ptr_ == this->inlineData();
+	}
+	// Makes the inline slots the (empty) buffer. With InlineCapacity 0 that is no buffer at all.
+	void useInline() noexcept
+	{
+		ptr_ = this->inlineData();
+		capacity_ = InlineCapacity;
+		Buffer::construct(alloc_, ptr_, capacity_, SJCFill::ForOverwrite);
+	}
+	void releaseBuffer() noexcept
+	{
+		if (isInline()) Buffer::destroy(alloc_, ptr_, capacity_);
+		else if (deleter_) {
+			Buffer::destroy(alloc_, ptr_, capacity_);
+			deallocate(ptr_, capacity_);
+		}
+		else Buffer::release(alloc_, ptr_, capacity_);
+	}
+	// Frees the memory of a heap buffer whose slots are already destroyed: through the deleter if it was
+	// adopted, which leaves deleter_ empty, otherwise through the allocator
+	void deallocate(T* p, size_t n) noexcept
+	{
+		if (deleter_) std::exchange(deleter_, {})(p, n);
+		else traits::deallocate(alloc_, p, n);
+	}
+	// At least one side is inline, so its items have to be moved rather than handed over.
+	// Runs before size_ is swapped, so size() still counts each side's own items.
+	void swapInline(BasicSJCVector& rhs) noexcept
+	{
+		if constexpr (InlineCapacity > 0) {
+			if (isInline() && rhs.isInline()) {
+				SJCInlineStorage<T, InlineCapacity> tmp;
+				Buffer::moveInto(alloc_, ptr_, capacity_, size(), tmp.inlineData(), InlineCapacity);
+				Buffer::moveInto(alloc_, rhs.ptr_, rhs.capacity_, rhs.size(), ptr_, InlineCapacity);
+				Buffer::moveInto(alloc_, tmp.inlineData(), InlineCapacity, size(), rhs.ptr_, InlineCapacity);
+				record(SJCEvent::CopyData, (2 * size() + rhs.size()) * sizeof(T));
+				return;
+			}
+			BasicSJCVector& inlined = isInline() ? *this : rhs;
+			BasicSJCVector& spilled = isInline() ? rhs : *this;
+			T* heap = spilled.ptr_;
+			const size_t heapSize = spilled.capacity_;
+			spilled.ptr_ = spilled.inlineData();
+			spilled.capacity_ = InlineCapacity;
+			Buffer::moveInto(alloc_, inlined.ptr_, inlined.capacity_, inlined.size(), spilled.ptr_, InlineCapacity);
+			record(SJCEvent::CopyData, inlined.size() * sizeof(T));
+			inlined.ptr_ = heap;
+			inlined.capacity_ = heapSize;
+			inlined.deleter_ = std::exchange(spilled.deleter_, {});
+		}
+	}
+	// ASSIGNMENT HELPERS
+	// ====================
+	// True if copy assignment from rhs can copy into this vector's buffer. Self assignment trivially can.
+	bool reuses(const BasicSJCVector& rhs) const noexcept
+	{
+		if constexpr (copiesAllocator && !alwaysEqual) {
+			// rhs's allocator comes with the copy, so memory from ours cannot be kept
+			if (!(alloc_ == rhs.alloc_)) return false;
+		}
+		return rhs.size() <= capacity_;
+	}
+	// Copies rhs's items over the first slots. The slots after them stay as they are: live, and free.
+	void copyItems(const BasicSJCVector& rhs)
+	{
+		if (this == &rhs) return;
+		const size_t count = rhs.size();
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			if (count > 0) std::memcpy(static_cast<void*>(ptr_), rhs.ptr_, count * sizeof(T));
+		}
+		else {
+			// Every slot holds a live T, so the items are copy assigned. A throw leaves the vector empty.
+			size_ = 0;
+			std::copy(rhs.ptr_, rhs.ptr_ + count, ptr_);
+		}
+		record(SJCEvent::CopyData, count * sizeof(T));
+		size_ = rhs.size_;
+	}
+	// ALLOCATOR HELPERS
+	// ===================
+	// Takes over from's buffer, or moves its items over when they are inline, and leaves from empty.
+	// This vector's own buffer must be released (or never made), and its allocator must be able to free from's.
+	void takeBuffer(BasicSJCVector& from) noexcept
+	{
+		if (from.isInline()) {
+			// Nothing to steal, the items live inside from
+			ptr_ = this->inlineData();
+			capacity_ = InlineCapacity;
+			Buffer::moveInto(alloc_, from.ptr_, from.capacity_, from.size(), ptr_, capacity_);
+			record(SJCEvent::CopyData, from.size() * sizeof(T));
+			from.useInline();
+		}
+		else {
+			ptr_ = std::exchange(from.ptr_, nullptr);	//ptr_ gets from.ptr_, from.ptr_ gets nullptr.
+			capacity_ = std::exchange(from.capacity_, 0);
+			deleter_ = std::exchange(from.deleter_, {});
+			if constexpr (InlineCapacity > 0) from.useInline();
+		}
+		size_ = std::exchange(from.size_, 0);
+	}
+	// Only used when the allocators differ and do not propagate.
+	// Replaces the items with from's, moved into memory from this vector's own allocator. from is left empty.
+	void takeItems(BasicSJCVector& from)
+	{
+		const size_t count = from.size();
+		if (from.capacity_ <= InlineCapacity) {
+			if (!isInline()) {
+				releaseBuffer();
+				useInline();
+			}
+			for (size_t i = 0; i < count; i++) ptr_[i] = std::move(from.ptr_[i]);
+			record(SJCEvent::CopyData, count * sizeof(T));
+			if (!from.isInline()) {
+				from.releaseBuffer();
+				from.useInline();
+			}
+		}
+		else {
+			T* p = traits::allocate(alloc_, from.capacity_);
+			try {
+				Buffer::moveInto(alloc_, from.ptr_, from.capacity_, count, p, from.capacity_);
+			}
+			catch (...) {
+				traits::deallocate(alloc_, p, from.capacity_);
+				throw;
+			}
+			record(SJCEvent::Allocate, from.capacity_ * sizeof(T));
+			record(SJCEvent::CopyData, count * sizeof(T));
+			releaseBuffer();
+			ptr_ = p;
+			capacity_ = from.capacity_;
+			// from's items are gone, only its memory is left to free
+			from.deallocate(from.ptr_, from.capacity_);
+			from.useInline();
+		}
+		size_ = count;
+		from.size_ = 0;
 	}
-	void printItems() const 
+	void printItems(std::ostream& os = std::cout, bool showSlots = true) const 
 	{
-		if (last_ < 0 || size_ == 0) return;
-		for (int i = 0; i <= last_; i++) {
-			std::cout << ptr_[i];
-			if (i != last_) std::cout << ", ";
+		if (size_ == 0 || capacity_ == 0) return;
+		for (size_t i = 0; i < size_; i++) {
+			os << ptr_[i];
+			if (i + 1 != size_) os << ", ";
 		}
-		std::cout << " ";
-		if (size_ == last_ + 1) std::cout << "(full) ";
-		else std::cout << "(" << size_ - (last_ + 1) << " slots left) ";
+		if (!showSlots) return;
+		os << " ";
+		if (capacity_ == size_) os << "(full) ";
+		else os << "(" << capacity_ - size_ << " slots left) ";
 	}
 	void printItemsLn() const 
 	{
 		printItems();
-		std::cout << std::endl;
+		std::cout << '\n';
 	}
 	void printName() const 
 	{
-		if (name_.size() > 0) std::cout << name_ << " ";
-		else std::cout << "Unnamed SJCVector ";
+		std::cout << SJCName{ name_ };
 	}
 	void printNameLn() const 
 	{
 		printName();
-		std::cout << std::endl;
+		std::cout << '\n';
 	}
 	void printSize() const 
 	{
-		std::cout << "Size:" << size_;
-		if (size_ == 0)std::cout << " empty ";
-		else std::cout << " has " << last_ + 1 << " items: ";
+		std::cout << "Size:" << capacity_;
+		if (capacity_ == 0)std::cout << " empty ";
+		else std::cout << " has " << size_ << " items: ";
 	}
 	void printSizeLn() const 
 	{
@@ -341,3 +921,13 @@ private:
 	}
 };
 
+// SJCVectorOf<double>, SJCVectorOf<float> etc. share SJCVector's trace policy
+template <typename T>
+using SJCVectorOf = BasicSJCVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY>;
+using SJCVector = SJCVectorOf<int>;
+// Up to N items without touching the heap
+template <typename T, std::size_t N = 16>
+using SJCSmallVectorOf = BasicSJCVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY, SJCDoublingGrowth, N>;
+// Copy assignment reuses the destination's buffer when the items fit (see SJCAssignPolicy.h)
+template <typename T>
+using SJCReusingVectorOf = BasicSJCVector<T, std::allocator<T>, SJCVECTOR_TRACE_POLICY, SJCDoublingGrowth, 0, SJCReuseAssign>;
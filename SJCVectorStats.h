@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+#include "SJCVectorTrace.h"
+
+// SPECIAL MEMBER FUNCTION STATISTICS
+// ==================================
+// CountingTrace feeds every SJCVector event into SJCStatsRegistry, which keeps one SJCStats
+// for everything, one per vector type and one per vector name (the name at the time of the event).
+// Take a snapshot before and after an expression and subtract them to see what the expression did:
+//		using Vec = BasicSJCVector<int, std::allocator<int>, CountingTrace>;	// SJCVector's SilentTrace counts nothing
+//		auto before = SJCStatsRegistry::snapshot();
+//		Vec o(n + m);
+//		auto diff = SJCStatsRegistry::snapshot() - before;
+//		assert(diff.total.copies() == 0 && diff.total.allocations() == 1);
+// Recording never throws: it runs inside the vectors' noexcept move constructors, swaps and destructors. An
+// event whose per-type or per-name entry cannot be allocated is still in total and is counted in dropped.
+
+struct SJCStats {
+	std::array<std::size_t, static_cast<std::size_t>(SJCEvent::Count)> events{};
+	std::size_t bytesCopied{ 0 };
+	std::size_t bytesAllocated{ 0 };
+
+	std::size_t operator[](SJCEvent e) const noexcept { return events[static_cast<std::size_t>(e)]; }
+	std::size_t constructions() const noexcept
+	{
+		return (*this)[SJCEvent::DefaultCtor] + (*this)[SJCEvent::SizedCtor] + (*this)[SJCEvent::NamedCtor]
+			+ (*this)[SJCEvent::CopyCtor] + (*this)[SJCEvent::MoveCtor] + (*this)[SJCEvent::ExprCtor];
+	}
+	std::size_t copies() const noexcept { return (*this)[SJCEvent::CopyCtor] + (*this)[SJCEvent::CopyAssign]; }
+	std::size_t moves() const noexcept { return (*this)[SJCEvent::MoveCtor] + (*this)[SJCEvent::MoveAssign]; }
+	std::size_t allocations() const noexcept { return (*this)[SJCEvent::Allocate]; }
+
+	void add(SJCEvent e, std::size_t bytes) noexcept
+	{
+		++events[static_cast<std::size_t>(e)];
+		if (e == SJCEvent::CopyData) bytesCopied += bytes;
+		else if (e == SJCEvent::Allocate) bytesAllocated += bytes;
+	}
+	SJCStats& operator-=(const SJCStats& rhs) noexcept
+	{
+		for (std::size_t i = 0; i < events.size(); i++) events[i] -= rhs.events[i];
+		bytesCopied -= rhs.bytesCopied;
+		bytesAllocated -= rhs.bytesAllocated;
+		return *this;
+	}
+	friend SJCStats operator-(SJCStats lhs, const SJCStats& rhs) noexcept { return lhs -= rhs; }
+	friend std::ostream& operator<<(std::ostream& os, const SJCStats& s)
+	{
+		return os << "ctors:" << s.constructions() << " copies:" << s.copies() << " moves:" << s.moves()
+			<< " by-value assigns:" << s[SJCEvent::ByValueAssign] << " swaps:" << s[SJCEvent::Swap]
+			<< " dtors:" << s[SJCEvent::Dtor] << " allocations:" << s.allocations()
+			<< " bytes allocated:" << s.bytesAllocated << " bytes copied:" << s.bytesCopied;
+	}
+};
+
+struct SJCStatsSnapshot {
+	SJCStats total;
+	std::map<std::type_index, SJCStats> byType;
+	std::map<std::string, SJCStats> byName;
+	std::size_t dropped{ 0 };		// Events missing from byType or byName because an entry could not be allocated
+
+	const SJCStats& forName(const std::string& name) const { return find(byName, name); }
+	template <typename Vec>
+	const SJCStats& forType() const { return find(byType, std::type_index(typeid(Vec))); }
+
+	// Difference between two snapshots. Keys missing from rhs count as zero.
+	friend SJCStatsSnapshot operator-(SJCStatsSnapshot lhs, const SJCStatsSnapshot& rhs)
+	{
+		lhs.total -= rhs.total;
+		for (const auto& [type, stats] : rhs.byType) lhs.byType[type] -= stats;
+		for (const auto& [name, stats] : rhs.byName) lhs.byName[name] -= stats;
+		lhs.dropped -= rhs.dropped;
+		return lhs;
+	}
+private:
+	template <typename Map, typename Key>
+	static const SJCStats& find(const Map& map, const Key& key)
+	{
+		static const SJCStats none{};
+		auto it = map.find(key);
+		return it == map.end() ? none : it->second;
+	}
+};
+
+class SJCStatsRegistry {
+public:
+	static void record(std::type_index type, const std::string& name, SJCEvent e, std::size_t bytes) noexcept
+	{
+		try {
+			std::lock_guard<std::mutex> lock(mutex());
+			auto& s = state();
+			s.total.add(e, bytes);
+			try {
+				s.byType[type].add(e, bytes);
+				s.byName[name].add(e, bytes);
+			}
+			catch (...) {
+				s.dropped++;
+			}
+		}
+		catch (...) {
+			// Only the lock itself can get here, and then nothing can be counted safely
+		}
+	}
+	static SJCStatsSnapshot snapshot()
+	{
+		std::lock_guard<std::mutex> lock(mutex());
+		return state();
+	}
+	static void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex());
+		state() = SJCStatsSnapshot{};
+	}
+private:
+	static std::mutex& mutex()
+	{
+		static std::mutex m;
+		return m;
+	}
+	static SJCStatsSnapshot& state()
+	{
+		static SJCStatsSnapshot s;
+		return s;
+	}
+};
+
+struct CountingTrace {
+	static constexpr bool streaming = false;
+	template <typename Vec>
+	static void record(const Vec& v, SJCEvent e, std::size_t bytes = 0) noexcept
+	{
+		SJCStatsRegistry::record(std::type_index(typeid(Vec)), v.name(), e, bytes);
+	}
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// TRACE POLICIES
+// ==============
+// Every special member function of SJCVector reports itself through a trace policy.
+// The policy is a template parameter, so the choice is made at compile time:
+// SilentTrace   - records nothing. All trace calls compile away, so a move constructor is just
+//                 the pointer exchange. Use this for production builds.
+// CountingTrace - counts calls per event, type and name. No output. See SJCVectorStats.h.
+// StreamTrace   - the verbose teaching output, written to std::cout.
+// A policy provides:
+//		static constexpr bool streaming;					// true if out() should receive text
+//		template <typename Vec> static void record(const Vec&, SJCEvent, std::size_t bytes = 0) noexcept;
+//		static std::ostream& out();							// only needed when streaming is true
+// record() must not throw: the noexcept move constructors, swaps and destructors call it.
+
+// The policy used by the SJCVector aliases. Define as StreamTrace before including for the teaching output.
+#ifndef SJCVECTOR_TRACE_POLICY
+#define SJCVECTOR_TRACE_POLICY SilentTrace
+#endif
+
+enum class SJCEvent {
+	DefaultCtor,
+	SizedCtor,
+	NamedCtor,
+	Dtor,
+	CopyCtor,
+	MoveCtor,
+	ByValueAssign,
+	CopyAssign,
+	MoveAssign,
+	Swap,
+	PushBack,
+	PushFront,
+	Pop,		// pop_front and pop_back
+	Resize,
+	Rename,
+	Add,		// in-place +=
+	Subtract,	// in-place -=
+	Multiply,	// in-place *=
+	ExprCtor,	// construction from an expression template
+	ExprAssign,	// assignment from an expression template
+	Adopt,		// adopt(): an external buffer taken over
+	Release,	// release(): the buffer handed out
+	Allocate,	// bytes = size of the new buffer
+	CopyData,	// bytes = amount of element data copied
+	Count		// Number of events, not an event
+};
+
+struct SilentTrace {
+	static constexpr bool streaming = false;
+	template <typename Vec>
+	static void record(const Vec&, SJCEvent, std::size_t = 0) noexcept {}
+};
+
+struct StreamTrace {
+	static constexpr bool streaming = true;
+	template <typename Vec>
+	static void record(const Vec&, SJCEvent, std::size_t = 0) noexcept {}
+	static std::ostream& out() { return std::cout; }
+};
+
+// Streams a vector name followed by a space, or a placeholder if the name is empty.
+// Holds a reference only, so passing one to a silent trace costs nothing.
+struct SJCName {
+	const std::string& name;
+};
+inline std::ostream& operator<<(std::ostream& os, SJCName n)
+{
+	if (n.name.size() > 0) return os << n.name << " ";
+	return os << "Unnamed SJCVector ";
+}
+
+// TRACING HELPERS
+// ===============
+// The vector classes derive privately from SJCTraced<Self, TracePolicy> for their record() and trace(), so
+// they all report the same way:
+//		using Traced = SJCTraced<BasicSJCRingVector, TracePolicy>;
+//		friend Traced;			// lets record() pass the vector itself to the policy
+//		using Traced::record;
+//		using Traced::trace;
+// record() reports an event to the policy. trace(event, args...) records and also streams its arguments when
+// the policy is streaming; trace(args...) only streams. With SilentTrace they are all empty inline functions,
+// so nothing is left after optimization.
+template <typename Derived, typename TracePolicy>
+class SJCTraced {
+protected:
+	void record(SJCEvent e, std::size_t bytes = 0) const noexcept
+	{
+		TracePolicy::record(static_cast<const Derived&>(*this), e, bytes);
+	}
+	template <typename... Args>
+	void trace(SJCEvent e, const Args&... args) const
+	{
+		record(e);
+		trace(args...);
+	}
+	template <typename... Args>
+	void trace(const Args&... args) const
+	{
+		if constexpr (TracePolicy::streaming && sizeof...(Args) > 0) (TracePolicy::out() << ... << args);
+	}
+};
@@ -1,5 +1,7 @@
 
 
+// The teaching build streams every special member function call to the console
+#define SJCVECTOR_TRACE_POLICY StreamTrace
 #include "SJCVector.h"
 
 
@@ -35,8 +37,9 @@ int main() {
 	n.push_back(2);
 	n.print();
 	
-	std::cout << "\nTest move constructor and + operator overload\n";
-	SJCVector o(n + m);
+	std::cout << "\nTest + operator overload and move constructor\n";
+	SJCVector sum(n + m);	// n + m is an expression template, evaluated in one pass by the constructor
+	SJCVector o(std::move(sum));
 	o.rename("oscar");
 	o.print();
 
@@ -47,7 +50,7 @@ int main() {
 
 	std::cout << "\nTest move assignment operator\n";
 	SJCVector p("pelle");
-	p = n + o;
+	p = SJCVector(n + o);
 	n.print();
 	o.print();
 	p.print();